@@ -0,0 +1,179 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_frames)
+    : num_frames_(num_frames),
+      correlation_window_(std::max<size_t>(num_frames / 16, 1)),
+      frames_(num_frames),
+      b1_(2 * num_frames),
+      b2_(2 * num_frames) {}
+
+void ARCReplacer::Forget(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  if (info.evictable_) {
+    curr_size_--;
+  }
+  if (info.queue_ != Queue::NONE) {
+    ListOf(info.queue_).erase(info.pos_);
+  }
+  info = FrameInfo();
+}
+
+void ARCReplacer::TrimGhosts() {
+  while (b1_.Size() > 0 && t1_.size() + b1_.Size() > num_frames_) {
+    b1_.PopOldest();
+  }
+  while (t1_.size() + t2_.size() + b1_.Size() + b2_.Size() > 2 * num_frames_) {
+    if (b2_.Size() > 0) {
+      b2_.PopOldest();
+    } else if (b1_.Size() > 0) {
+      b1_.PopOldest();
+    } else {
+      break;
+    }
+  }
+}
+
+auto ARCReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  Queue order[2] = {Queue::T2, Queue::T1};
+  if (PreferT1()) {
+    std::swap(order[0], order[1]);
+  }
+  for (Queue queue : order) {
+    for (frame_id_t candidate : ListOf(queue)) {
+      if (!frames_[candidate].evictable_) {
+        continue;
+      }
+      page_id_t page_id = frames_[candidate].page_id_;
+      Forget(candidate);
+      if (page_id != INVALID_PAGE_ID) {
+        (queue == Queue::T1 ? b1_ : b2_).Push(page_id);
+        TrimGhosts();
+      }
+      *frame_id = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ARCReplacer::RecordLoad(frame_id_t frame_id, page_id_t page_id) {
+  BUSTUB_ASSERT((size_t)frame_id < num_frames_, "frame id is invalid");
+  std::scoped_lock<std::mutex> lock(latch_);
+  FrameInfo &info = frames_[frame_id];
+  info.page_id_ = page_id;
+  info.hot_ = false;
+  if (b1_.Contains(page_id)) {
+    // Recency miss: T1 should have been larger.
+    size_t delta = std::max<size_t>(b2_.Size() / b1_.Size(), 1);
+    p_ = std::min(p_ + delta, num_frames_);
+    b1_.Erase(page_id);
+    info.hot_ = true;
+  } else if (b2_.Contains(page_id)) {
+    // Frequency miss: T2 should have been larger.
+    size_t delta = std::max<size_t>(b1_.Size() / b2_.Size(), 1);
+    p_ = p_ > delta ? p_ - delta : 0;
+    b2_.Erase(page_id);
+    info.hot_ = true;
+  }
+}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id) {
+  BUSTUB_ASSERT((size_t)frame_id < num_frames_, "frame id is invalid");
+  std::scoped_lock<std::mutex> lock(latch_);
+  FrameInfo &info = frames_[frame_id];
+  switch (info.queue_) {
+    case Queue::NONE:
+      info.queue_ = info.hot_ ? Queue::T2 : Queue::T1;
+      ListOf(info.queue_).push_back(frame_id);
+      info.pos_ = std::prev(ListOf(info.queue_).end());
+      info.load_seq_ = loads_++;
+      TrimGhosts();
+      break;
+    case Queue::T1:
+      if (loads_ - info.load_seq_ - 1 < correlation_window_) {
+        // Correlated with the load, e.g. the next tuple of a scan: keep the page in T1, as most recently used.
+        t1_.splice(t1_.end(), t1_, info.pos_);
+        break;
+      }
+      t2_.splice(t2_.end(), t1_, info.pos_);
+      info.queue_ = Queue::T2;
+      break;
+    case Queue::T2:
+      t2_.splice(t2_.end(), t2_, info.pos_);
+      break;
+  }
+}
+
+void ARCReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  BUSTUB_ASSERT((size_t)frame_id < num_frames_, "frame id is invalid");
+  std::scoped_lock<std::mutex> lock(latch_);
+  FrameInfo &info = frames_[frame_id];
+  if (info.queue_ == Queue::NONE || info.evictable_ == set_evictable) {
+    return;
+  }
+  info.evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  BUSTUB_ASSERT((size_t)frame_id < num_frames_, "frame id is invalid");
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (frames_[frame_id].queue_ == Queue::NONE) {
+    return;
+  }
+  BUSTUB_ASSERT(frames_[frame_id].evictable_, "frame can't be removed");
+  Forget(frame_id);
+}
+
+auto ARCReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  // Approximation: assumes the list Evict() prefers right now stays preferred until it runs dry.
+  Queue order[2] = {Queue::T2, Queue::T1};
+  if (PreferT1()) {
+    std::swap(order[0], order[1]);
+  }
+  std::vector<frame_id_t> ret;
+  for (Queue queue : order) {
+    for (auto it = ListOf(queue).begin(); it != ListOf(queue).end() && ret.size() < max_count; ++it) {
+      if (frames_[*it].evictable_) {
+        ret.push_back(*it);
+      }
+    }
+  }
+  return ret;
+}
+
+auto ARCReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
+}
+
+auto ARCReplacer::GetTarget() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return p_;
+}
+
+}  // namespace bustub
@@ -12,163 +12,544 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include "common/exception.h"
 #include "common/macros.h"
 
 namespace bustub {
 
+/** @return the lowest page id at or after page_id that belongs to the given instance */
+static auto FirstPageIdAtOrAfter(page_id_t page_id, uint32_t num_instances, uint32_t instance_index) -> page_id_t {
+  auto offset = (instance_index + num_instances - static_cast<uint32_t>(page_id) % num_instances) % num_instances;
+  return page_id + static_cast<page_id_t>(offset);
+}
+
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];
-  page_table_ = new ExtendibleHashTable<page_id_t, frame_id_t>(bucket_size_);
-  replacer_ = new LRUKReplacer(pool_size_, replacer_k);
+                                                     LogManager *log_manager, ReplacerPolicy replacer_policy,
+                                                     size_t max_pool_size)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, replacer_k, log_manager, replacer_policy,
+                                max_pool_size) {}
 
-  // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_.emplace_back(static_cast<int>(i));
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, ReplacerPolicy replacer_policy,
+                                                     size_t max_pool_size)
+    : pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, max_pool_size)),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      // Pages up to the end of the database file may be in use, unless the free-page map says otherwise.
+      next_page_id_(FirstPageIdAtOrAfter(disk_manager->GetNumPages(), num_instances, instance_index)),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      disk_scheduler_(new DiskScheduler(disk_manager)) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(
+      instance_index < num_instances,
+      "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 0.");
+  // The book-keeping and the address space of all max_pool_size_ frames are allocated up front, so that they never move
+  // while lock-free lookups read them. Only the frames in use touch their page buffer.
+  pages_ = new Page[max_pool_size_];
+  arena_ = new FrameArena(max_pool_size_, enable_huge_pages);
+  page_table_ = new PageTable(max_pool_size_);
+  replacer_ = MakeReplacer(replacer_policy, max_pool_size_, replacer_k);
+  io_pending_ = new std::atomic<bool>[max_pool_size_]();
+  write_in_flight_ = new bool[max_pool_size_]();
+  io_cv_ = new std::condition_variable[max_pool_size_];
+
+  // Initially, every frame in use is in the free list.
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    pages_[i].data_ = arena_->GetFrame(static_cast<frame_id_t>(i));
+    if (i < pool_size_) {
+      free_list_.emplace_back(static_cast<int>(i));
+    } else {
+      retired_frames_.emplace_back(static_cast<int>(i));
+    }
   }
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  StopBackgroundWriter();
+  StopPrefetcher();
+  // Readers should have unpinned their pages by now.
+  for (const auto &[page_id, view] : views_) {
+    disk_manager_->ReleasePageView(page_id);
+  }
+  delete disk_scheduler_;
   delete[] pages_;
+  delete arena_;
   delete page_table_;
   delete replacer_;
+  delete[] io_pending_;
+  delete[] write_in_flight_;
+  delete[] io_cv_;
 }
 
-auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
-  std::scoped_lock<std::mutex> lock(latch_);
-  if (!free_list_.empty()) {
-    frame_id_t free_frame = free_list_.front();
+auto BufferPoolManagerInstance::TakeRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id) -> bool {
+  if (strategy == nullptr || !strategy->IsFull()) {
+    return false;
+  }
+  auto &ring = strategy->GetRing();
+  for (auto it = ring.begin(); it != ring.end();) {
+    // In a parallel pool the ring also holds pages of other shards; leave those to them.
+    if (static_cast<uint32_t>(*it) % num_instances_ != instance_index_) {
+      ++it;
+      continue;
+    }
+    frame_id_t candidate;
+    if (!page_table_->Find(*it, &candidate)) {
+      // Evicted by someone else in the meantime.
+      it = ring.erase(it);
+      continue;
+    }
+    if (pages_[candidate].GetPinCount() != 0 || io_pending_[candidate]) {
+      ++it;
+      continue;
+    }
+    ring.erase(it);
+    replacer_->Remove(candidate);
+    *frame_id = candidate;
+    return true;
+  }
+  return false;
+}
+
+void BufferPoolManagerInstance::DetachVictim(std::unique_lock<std::mutex> *lock, page_id_t page_id, frame_id_t frame_id,
+                                             page_id_t *dirty_page_id) {
+  Page &victim = pages_[frame_id];
+  if (write_in_flight_[frame_id]) {
+    // The victim is being flushed from its frame. Hold off lookups of its page and wait for the write to finish
+    // before the frame is reused. The latch is released meanwhile, so also hold off other loads of page_id: they
+    // wait for this frame like for a write-back, and find the page in it once the caller has installed it.
+    io_pending_[frame_id] = true;
+    if (page_id != INVALID_PAGE_ID) {
+      write_back_[page_id] = frame_id;
+    }
+    stats_.Add(BufferPoolCounter::PIN_WAITS);
+    io_cv_[frame_id].wait(*lock, [&] { return !write_in_flight_[frame_id]; });
+    write_back_.erase(page_id);
+  }
+  page_table_->Remove(victim.GetPageId());
+  if (victim.IsDirty()) {
+    *dirty_page_id = victim.GetPageId();
+    write_back_[*dirty_page_id] = frame_id;
+    stats_.Add(BufferPoolCounter::DIRTY_EVICTIONS);
+    background_writer_cv_.notify_one();
+  } else {
+    stats_.Add(BufferPoolCounter::CLEAN_EVICTIONS);
+  }
+}
+
+auto BufferPoolManagerInstance::ReserveFrame(std::unique_lock<std::mutex> *lock, page_id_t page_id,
+                                             BufferAccessStrategy *strategy, frame_id_t *frame_id,
+                                             page_id_t *dirty_page_id) -> bool {
+  *dirty_page_id = INVALID_PAGE_ID;
+  // A scan with a full ring recycles its own frames before it takes a free or evictable one from everybody else.
+  bool from_ring = TakeRingFrame(strategy, frame_id);
+  if (!from_ring && !free_list_.empty()) {
+    *frame_id = free_list_.front();
     free_list_.pop_front();
-    *page_id = AllocatePage();
-    page_table_->Insert(*page_id, free_frame);
-    pages_[free_frame].is_dirty_ = false;
-    pages_[free_frame].page_id_ = *page_id;
-    pages_[free_frame].pin_count_ = 1;
-    pages_[free_frame].ResetMemory();
-    replacer_->RecordAccess(free_frame);
-    replacer_->SetEvictable(free_frame, false);
-    return &pages_[free_frame];
-  }
-  frame_id_t ret;
-  if (!replacer_->Evict(&ret)) {
+  } else {
+    if (!from_ring && !replacer_->Evict(frame_id)) {
+      stats_.Add(BufferPoolCounter::FAILED_EVICTIONS);
+      return false;
+    }
+    DetachVictim(lock, page_id, *frame_id, dirty_page_id);
+  }
+  if (page_id == INVALID_PAGE_ID) {
+    page_id = AllocatePage();
+  }
+  // Mark the I/O pending before the frame takes its new identity, and publish the mapping last, so that the lock-free
+  // hit path never hands out the frame before its data is there.
+  io_pending_[*frame_id] = true;
+  pages_[*frame_id].is_dirty_ = false;
+  pages_[*frame_id].page_id_ = page_id;
+  pages_[*frame_id].pin_count_ = 1;
+  auto view = views_.find(page_id);
+  if (view != views_.end()) {
+    // The readers of the page in place unpin it by id, which from now on finds the frame, so it takes over their pins.
+    pages_[*frame_id].pin_count_ += view->second.pins_;
+    view->second.adopted_ = true;
+  }
+  page_table_->Insert(page_id, *frame_id);
+  replacer_->RecordLoad(*frame_id, page_id);
+  replacer_->RecordAccess(*frame_id);
+  replacer_->SetEvictable(*frame_id, false);
+  if (strategy != nullptr) {
+    strategy->Push(page_id);
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::ReadFromDisk(page_id_t page_id, char *page_data) {
+  auto start = std::chrono::steady_clock::now();
+  disk_manager_->ReadPage(page_id, page_data);
+  stats_.GetReadLatency().Record(std::chrono::steady_clock::now() - start);
+}
+
+void BufferPoolManagerInstance::WriteToDisk(page_id_t page_id, const char *page_data) {
+  auto start = std::chrono::steady_clock::now();
+  disk_manager_->WritePage(page_id, page_data);
+  stats_.GetWriteLatency().Record(std::chrono::steady_clock::now() - start);
+}
+
+auto BufferPoolManagerInstance::SubmitIo(bool is_write, const std::vector<std::pair<page_id_t, frame_id_t>> &pages)
+    -> std::vector<PendingIo> {
+  std::vector<DiskRequest> requests;
+  std::vector<PendingIo> pending;
+  requests.reserve(pages.size());
+  pending.reserve(pages.size());
+  auto submitted = std::chrono::steady_clock::now();
+  for (const auto &[page_id, frame_id] : pages) {
+    requests.push_back({is_write, pages_[frame_id].GetData(), page_id, DiskScheduler::CreatePromise()});
+    pending.push_back({requests.back().callback_.get_future(), is_write, submitted});
+  }
+  disk_scheduler_->Schedule(&requests);
+  return pending;
+}
+
+void BufferPoolManagerInstance::AwaitIo(PendingIo *io) {
+  io->done_.get();
+  auto &latency = io->is_write_ ? stats_.GetWriteLatency() : stats_.GetReadLatency();
+  latency.Record(std::chrono::steady_clock::now() - io->submitted_);
+}
+
+void BufferPoolManagerInstance::FinishIo(frame_id_t frame_id, page_id_t dirty_page_id) {
+  if (dirty_page_id != INVALID_PAGE_ID) {
+    write_back_.erase(dirty_page_id);
+  }
+  io_pending_[frame_id] = false;
+  io_cv_[frame_id].notify_all();
+}
+
+auto BufferPoolManagerInstance::WaitForPage(std::unique_lock<std::mutex> *lock, page_id_t page_id,
+                                            frame_id_t *frame_id) -> bool {
+  while (true) {
+    if (page_table_->Find(page_id, frame_id)) {
+      if (!io_pending_[*frame_id]) {
+        return true;
+      }
+      // Another thread is loading this page. Wait on its frame only; the frame may hold a different page by the
+      // time we wake up, so look the page up again.
+      frame_id_t loading = *frame_id;
+      stats_.Add(BufferPoolCounter::PIN_WAITS);
+      io_cv_[loading].wait(*lock, [&] { return !io_pending_[loading]; });
+      continue;
+    }
+    auto it = write_back_.find(page_id);
+    if (it == write_back_.end()) {
+      return false;
+    }
+    // The page was evicted dirty and its write-back has not reached the disk yet, so reading it now would see stale
+    // data.
+    frame_id_t writer = it->second;
+    stats_.Add(BufferPoolCounter::PIN_WAITS);
+    io_cv_[writer].wait(*lock, [&] { return write_back_.count(page_id) == 0; });
+  }
+}
+
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
+  std::unique_lock<std::mutex> lock(latch_);
+  frame_id_t frame_id;
+  page_id_t dirty_page_id;
+  // Let ReserveFrame() allocate the page id, so that one is only consumed if a frame is available for it.
+  if (!ReserveFrame(&lock, INVALID_PAGE_ID, nullptr, &frame_id, &dirty_page_id)) {
     return nullptr;
   }
-  page_table_->Remove(pages_[ret].GetPageId());
-  if (pages_[ret].IsDirty()) {
-    disk_manager_->WritePage(pages_[ret].GetPageId(), pages_[ret].GetData());
+  *page_id = pages_[frame_id].GetPageId();
+  stats_.Add(BufferPoolCounter::NEW_PAGES);
+  lock.unlock();
+
+  Page *page = &pages_[frame_id];
+  if (dirty_page_id != INVALID_PAGE_ID) {
+    WriteToDisk(dirty_page_id, page->GetData());
   }
-  *page_id = AllocatePage();
-  page_table_->Insert(*page_id, ret);
-  pages_[ret].is_dirty_ = false;
-  pages_[ret].page_id_ = *page_id;
-  pages_[ret].pin_count_ = 1;
-  pages_[ret].ResetMemory();
-  replacer_->RecordAccess(ret);
-  replacer_->SetEvictable(ret, false);
-  return &pages_[ret];
+  page->ResetMemory();
+
+  lock.lock();
+  FinishIo(frame_id, dirty_page_id);
+  return page;
 }
 
-auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
-  std::scoped_lock<std::mutex> lock(latch_);
-  frame_id_t buffer_ret;
-  if (page_table_->Find(page_id, buffer_ret)) {
-    pages_[buffer_ret].pin_count_++;
-    replacer_->RecordAccess(buffer_ret);
-    replacer_->SetEvictable(buffer_ret, false);
-    return &pages_[buffer_ret];
-  }
-  if (!free_list_.empty()) {
-    frame_id_t free_frame = free_list_.front();
-    free_list_.pop_front();
-    page_table_->Insert(page_id, free_frame);
-    pages_[free_frame].is_dirty_ = false;
-    pages_[free_frame].page_id_ = page_id;
-    pages_[free_frame].pin_count_ = 1;
-    // pages_[free_frame].WLatch();
-    disk_manager_->ReadPage(page_id, pages_[free_frame].GetData());
-    // pages_[free_frame].WUnlatch();
-    replacer_->RecordAccess(free_frame);
-    replacer_->SetEvictable(free_frame, false);
-    return &pages_[free_frame];
-  }
-  frame_id_t ret;
-  if (!replacer_->Evict(&ret)) {
+auto BufferPoolManagerInstance::TryPinResident(page_id_t page_id, frame_id_t *frame_id) -> bool {
+  if (!page_table_->Find(page_id, frame_id)) {
+    return false;
+  }
+  Page *page = &pages_[*frame_id];
+  int pin_count = page->pin_count_.load();
+  do {
+    if (pin_count == 0) {
+      // Pinning an unpinned page makes it non-evictable, which must happen under the latch.
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+  // The lookup may have been stale: the frame may hold another page by now, or still be loading this one.
+  if (page->page_id_.load() != page_id || io_pending_[*frame_id].load()) {
+    ReleasePin(*frame_id);
+    return false;
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::ReleasePin(frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  int pin_count = page->pin_count_.load();
+  while (pin_count > 1) {
+    if (page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1)) {
+      return;
+    }
+  }
+  std::unique_lock<std::mutex> lock(latch_);
+  if (page->pin_count_.fetch_sub(1) == 1) {
+    replacer_->SetEvictable(frame_id, true);
+    page_id_t page_id = page->GetPageId();
+    if (DropAdoptedView(page_id)) {
+      lock.unlock();
+      disk_manager_->ReleasePageView(page_id);
+    }
+  }
+}
+
+auto BufferPoolManagerInstance::PinView(page_id_t page_id) -> Page * {
+  auto it = views_.find(page_id);
+  if (it != views_.end()) {
+    it->second.pins_++;
+    return it->second.page_.get();
+  }
+  const char *data = disk_manager_->AcquirePageView(page_id);
+  if (data == nullptr) {
     return nullptr;
   }
-  page_table_->Remove(pages_[ret].GetPageId());
-  if (pages_[ret].IsDirty()) {
-    // pages_[ret].RLatch();
-    disk_manager_->WritePage(pages_[ret].GetPageId(), pages_[ret].GetData());
-    // pages_[ret].RUnlatch();
+  auto page = std::make_unique<Page>();
+  // The view is mapped read-only, so a write through it faults instead of going unnoticed.
+  page->data_ = const_cast<char *>(data);  // NOLINT
+  page->page_id_ = page_id;
+  page->pin_count_ = 1;
+  Page *result = page.get();
+  views_.emplace(page_id, PageView{std::move(page), 1, false});
+  return result;
+}
+
+auto BufferPoolManagerInstance::DropAdoptedView(page_id_t page_id) -> bool {
+  auto it = views_.find(page_id);
+  if (it == views_.end() || !it->second.adopted_) {
+    return false;
+  }
+  views_.erase(it);
+  return true;
+}
+
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * { return FetchPgImp(page_id, nullptr); }
+
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  frame_id_t frame_id;
+  if (TryPinResident(page_id, &frame_id)) {
+    // The replacer has its own synchronization, and the frame stays tracked while we hold a pin on it.
+    replacer_->RecordAccess(frame_id);
+    stats_.Add(BufferPoolCounter::FETCH_HITS);
+    return &pages_[frame_id];
+  }
+
+  std::unique_lock<std::mutex> lock(latch_);
+  if (WaitForPage(&lock, page_id, &frame_id)) {
+    stats_.Add(BufferPoolCounter::FETCH_HITS);
+    pages_[frame_id].pin_count_++;
+    replacer_->RecordAccess(frame_id);
+    replacer_->SetEvictable(frame_id, false);
+    return &pages_[frame_id];
+  }
+  if (strategy != nullptr && strategy->IsReadOnly()) {
+    Page *view = PinView(page_id);
+    if (view != nullptr) {
+      stats_.Add(BufferPoolCounter::PAGE_VIEWS);
+      return view;
+    }
+  }
+  stats_.Add(BufferPoolCounter::FETCH_MISSES);
+  page_id_t dirty_page_id;
+  if (!ReserveFrame(&lock, page_id, strategy, &frame_id, &dirty_page_id)) {
+    return nullptr;
+  }
+  lock.unlock();
+
+  Page *page = &pages_[frame_id];
+  if (dirty_page_id != INVALID_PAGE_ID) {
+    WriteToDisk(dirty_page_id, page->GetData());
+  }
+  ReadFromDisk(page_id, page->GetData());
+
+  lock.lock();
+  FinishIo(frame_id, dirty_page_id);
+  return page;
+}
+
+void BufferPoolManagerInstance::PrefetchPgsImp(page_id_t first_page_id, size_t count, BufferAccessStrategy *strategy) {
+  if (strategy != nullptr && strategy->IsReadOnly() && disk_manager_->SupportsPageViews()) {
+    // The scan reads its misses in place, so frames would be wasted on them; the OS reads ahead on the mapping.
+    return;
   }
-  page_table_->Insert(page_id, ret);
-  pages_[ret].is_dirty_ = false;
-  pages_[ret].page_id_ = page_id;
-  pages_[ret].pin_count_ = 1;
-  // pages_[ret].WLatch();
-  disk_manager_->ReadPage(page_id, pages_[ret].GetData());
-  // pages_[ret].WUnlatch();
-  replacer_->RecordAccess(ret);
-  replacer_->SetEvictable(ret, false);
-  return &pages_[ret];
+  // Each prefetch holds a pinned frame until its read is done, so keep most of the pool available to everybody else.
+  const size_t max_in_flight = std::max<size_t>(1, pool_size_.load() / 4);
+  std::unique_lock<std::mutex> lock(latch_);
+  bool queued = false;
+  for (size_t i = 0; i < count && prefetches_in_flight_ < max_in_flight; ++i) {
+    auto page_id = static_cast<page_id_t>(first_page_id + i);
+    // Only pages this instance has allocated exist on disk; reading any other id would make it resident by accident.
+    if (page_id < 0 || static_cast<uint32_t>(page_id) % num_instances_ != instance_index_ || page_id >= next_page_id_ ||
+        disk_manager_->IsPageFree(page_id)) {
+      continue;
+    }
+    frame_id_t frame_id;
+    if (page_table_->Find(page_id, &frame_id) || write_back_.count(page_id) != 0) {
+      continue;
+    }
+    page_id_t dirty_page_id;
+    if (!ReserveFrame(&lock, page_id, strategy, &frame_id, &dirty_page_id)) {
+      break;
+    }
+    prefetch_queue_.push_back({page_id, frame_id, dirty_page_id});
+    prefetches_in_flight_++;
+    queued = true;
+  }
+  if (!queued) {
+    return;
+  }
+  if (prefetcher_ == nullptr) {
+    stop_prefetcher_ = false;
+    prefetcher_ = new std::thread(&BufferPoolManagerInstance::PrefetcherLoop, this);
+  }
+  prefetch_cv_.notify_one();
 }
 
 auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
   frame_id_t buffer_ret;
-  if (page_table_->Find(page_id, buffer_ret)) {
+  if (page_table_->Find(page_id, &buffer_ret) && pages_[buffer_ret].page_id_.load() == page_id) {
+    // Dropping a pin that is not the last one does not change evictability, so it needs no latch.
+    Page *page = &pages_[buffer_ret];
+    int pin_count = page->pin_count_.load();
+    while (pin_count > 1) {
+      if (is_dirty) {
+        page->is_dirty_ = true;
+      }
+      if (page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1)) {
+        return true;
+      }
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(latch_);
+  if (page_table_->Find(page_id, &buffer_ret)) {
     if (pages_[buffer_ret].GetPinCount() == 0) {
       return false;
     }
-    pages_[buffer_ret].pin_count_--;
-    if (pages_[buffer_ret].pin_count_ == 0) {
-      // pages_[buffer_ret].WLatch();
-      replacer_->SetEvictable(buffer_ret, true);
-      // pages_[buffer_ret].WUnlatch();
+    if (is_dirty) {
+      pages_[buffer_ret].is_dirty_ = true;
     }
-    if (!pages_[buffer_ret].is_dirty_) {
-      pages_[buffer_ret].is_dirty_ = is_dirty;
+    // Other pins may still come and go lock-free, but none can take the count from 0 while we hold the latch.
+    if (pages_[buffer_ret].pin_count_.fetch_sub(1) == 1) {
+      replacer_->SetEvictable(buffer_ret, true);
+      if (DropAdoptedView(page_id)) {
+        lock.unlock();
+        disk_manager_->ReleasePageView(page_id);
+      }
     }
     return true;
   }
-  return false;
+  // A page read in place; one whose view was adopted is resident, and was handled above.
+  auto view = views_.find(page_id);
+  if (view == views_.end()) {
+    return false;
+  }
+  BUSTUB_ASSERT(!is_dirty, "a page read in place cannot be modified");
+  if (--view->second.pins_ == 0) {
+    views_.erase(view);
+    lock.unlock();
+    disk_manager_->ReleasePageView(page_id);
+  }
+  return true;
 }
 
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
-  frame_id_t buffer_ret;
-  if (page_table_->Find(page_id, buffer_ret)) {
-    pages_[buffer_ret].is_dirty_ = false;
-    disk_manager_->WritePage(pages_[buffer_ret].GetPageId(), pages_[buffer_ret].GetData());
-    return true;
+  std::unique_lock<std::mutex> lock(latch_);
+  frame_id_t frame_id;
+  while (true) {
+    if (!WaitForPage(&lock, page_id, &frame_id)) {
+      return false;
+    }
+    if (!write_in_flight_[frame_id]) {
+      break;
+    }
+    io_cv_[frame_id].wait(lock, [&] { return !write_in_flight_[frame_id]; });
   }
-  return false;
+  // Mark the write in flight instead of pinning the frame, so that the frame stays evictable. An eviction waits for
+  // the write to finish before it reuses the frame.
+  Page *page = &pages_[frame_id];
+  write_in_flight_[frame_id] = true;
+  page->is_dirty_ = false;
+  lock.unlock();
+
+  WriteToDisk(page_id, page->GetData());
+  stats_.Add(BufferPoolCounter::FLUSHES);
+
+  lock.lock();
+  write_in_flight_[frame_id] = false;
+  io_cv_[frame_id].notify_all();
+  return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
-  std::scoped_lock<std::mutex> lock(latch_);
-  bool unused[pool_size_];
-  memset(unused, 0, sizeof(bool) * pool_size_);
-  for (int &it : free_list_) {
-    unused[it] = true;
-  }
-  for (size_t i = 0; i < pool_size_; i++) {
-    if (!unused[i]) {
+  std::vector<std::pair<page_id_t, frame_id_t>> batch;
+  std::vector<page_id_t> busy;
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    for (size_t i = 0; i < max_pool_size_; i++) {
+      page_id_t page_id = pages_[i].GetPageId();
+      if (page_id == INVALID_PAGE_ID) {
+        continue;
+      }
+      if (io_pending_[i] || write_in_flight_[i]) {
+        busy.push_back(page_id);
+        continue;
+      }
+      // Same as FlushPgImp(), but for all the frames at once.
+      write_in_flight_[i] = true;
       pages_[i].is_dirty_ = false;
-      disk_manager_->WritePage(pages_[i].GetPageId(), pages_[i].GetData());
+      batch.emplace_back(page_id, static_cast<frame_id_t>(i));
     }
   }
+
+  auto pending = SubmitIo(true, batch);
+  for (size_t i = 0; i < batch.size(); ++i) {
+    AwaitIo(&pending[i]);
+    stats_.Add(BufferPoolCounter::FLUSHES);
+    std::scoped_lock<std::mutex> lock(latch_);
+    write_in_flight_[batch[i].second] = false;
+    io_cv_[batch[i].second].notify_all();
+  }
+  // The pages that were being read or written a moment ago are flushed once that I/O is done.
+  for (page_id_t page_id : busy) {
+    FlushPgImp(page_id);
+  }
+  // The writes above may still sit in the OS page cache.
+  disk_manager_->SyncPages();
 }
 
 auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
+  std::unique_lock<std::mutex> lock(latch_);
   frame_id_t buffer_ret;
-  if (page_table_->Find(page_id, buffer_ret)) {
+  while (WaitForPage(&lock, page_id, &buffer_ret) && write_in_flight_[buffer_ret]) {
+    // The frame must not be reset under a flush; the page may be gone by the time the flush is done.
+    io_cv_[buffer_ret].wait(lock, [&] { return !write_in_flight_[buffer_ret]; });
+  }
+  if (views_.count(page_id) != 0) {
+    // Pinned by readers of the page in place.
+    return false;
+  }
+  if (page_table_->Find(page_id, &buffer_ret)) {
     if (pages_[buffer_ret].pin_count_ != 0) {
-      replacer_->SetEvictable(buffer_ret, true);
       return false;
     }
     replacer_->Remove(buffer_ret);
@@ -179,10 +560,220 @@ auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
     pages_[buffer_ret].pin_count_ = 0;
     pages_[buffer_ret].ResetMemory();
     DeallocatePage(page_id);
+  } else if (page_id >= 0 && static_cast<uint32_t>(page_id) % num_instances_ == instance_index_ &&
+             page_id < next_page_id_) {
+    // The page only lives on disk.
+    DeallocatePage(page_id);
   }
   return true;
 }
 
-auto BufferPoolManagerInstance::AllocatePage() -> page_id_t { return next_page_id_++; }
+auto BufferPoolManagerInstance::ResizePool(size_t pool_size) -> bool {
+  BUSTUB_ASSERT(pool_size > 0 && pool_size <= max_pool_size_, "pool size must be in [1, max_pool_size]");
+  std::scoped_lock<std::mutex> resize_lock(resize_latch_);
+  std::unique_lock<std::mutex> lock(latch_);
+  // Grow: hand retired frames out through the free list. Their page buffers are mapped already.
+  while (pool_size_ < pool_size) {
+    frame_id_t frame_id = retired_frames_.front();
+    retired_frames_.pop_front();
+    free_list_.push_back(frame_id);
+    pool_size_++;
+  }
+  // Shrink: retire free frames first, then drain evictable ones, writing dirty pages back like an eviction does.
+  while (pool_size_ > pool_size) {
+    frame_id_t frame_id;
+    if (!free_list_.empty()) {
+      frame_id = free_list_.back();
+      free_list_.pop_back();
+    } else {
+      if (!replacer_->Evict(&frame_id)) {
+        // Everything left is pinned; stop at the smallest size we could reach.
+        return false;
+      }
+      page_id_t dirty_page_id = INVALID_PAGE_ID;
+      DetachVictim(&lock, INVALID_PAGE_ID, frame_id, &dirty_page_id);
+      io_pending_[frame_id] = true;
+      if (dirty_page_id != INVALID_PAGE_ID) {
+        lock.unlock();
+        WriteToDisk(dirty_page_id, pages_[frame_id].GetData());
+        lock.lock();
+      }
+      FinishIo(frame_id, dirty_page_id);
+      pages_[frame_id].is_dirty_ = false;
+      pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+    }
+    // A lock-free lookup may still look at the frame's page id and pin count, but never at its data.
+    arena_->Release(frame_id);
+    retired_frames_.push_back(frame_id);
+    pool_size_--;
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::RunBackgroundWriter(size_t low_watermark, size_t high_watermark,
+                                                    std::chrono::milliseconds interval) {
+  BUSTUB_ASSERT(low_watermark <= high_watermark && high_watermark <= pool_size_,
+                "invalid background writer watermarks");
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (background_writer_ != nullptr) {
+    return;
+  }
+  low_watermark_ = low_watermark;
+  high_watermark_ = high_watermark;
+  background_writer_interval_ = interval;
+  stop_background_writer_ = false;
+  background_writer_ = new std::thread(&BufferPoolManagerInstance::BackgroundWriterLoop, this);
+}
+
+void BufferPoolManagerInstance::StopBackgroundWriter() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (background_writer_ == nullptr) {
+      return;
+    }
+    stop_background_writer_ = true;
+    background_writer_cv_.notify_one();
+  }
+  background_writer_->join();
+  delete background_writer_;
+  background_writer_ = nullptr;
+}
+
+void BufferPoolManagerInstance::BackgroundWriterLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (!stop_background_writer_) {
+    background_writer_cv_.wait_for(lock, background_writer_interval_);
+    if (stop_background_writer_) {
+      break;
+    }
+
+    // Count the frames a miss could take right now without a synchronous write. Only the next high_watermark_ victims
+    // matter, so the walk is bounded by that rather than by the pool size.
+    auto candidates = replacer_->EvictionCandidates(high_watermark_);
+    size_t clean = free_list_.size();
+    for (auto frame_id : candidates) {
+      if (!pages_[frame_id].IsDirty()) {
+        clean++;
+      }
+    }
+    if (clean >= low_watermark_) {
+      continue;
+    }
+
+    // Clean the next victims first. They are marked write-in-flight rather than pinned, so they stay evictable: an
+    // eviction that picks one waits for its write instead of failing.
+    std::vector<std::pair<page_id_t, frame_id_t>> batch;
+    for (auto frame_id : candidates) {
+      if (clean >= high_watermark_) {
+        break;
+      }
+      Page *page = &pages_[frame_id];
+      if (page->IsDirty() && !write_in_flight_[frame_id]) {
+        batch.emplace_back(page->GetPageId(), frame_id);
+        write_in_flight_[frame_id] = true;
+        page->is_dirty_ = false;
+        clean++;
+      }
+    }
+    if (batch.empty()) {
+      continue;
+    }
+    lock.unlock();
+
+    auto pending = SubmitIo(true, batch);
+    for (size_t i = 0; i < batch.size(); ++i) {
+      AwaitIo(&pending[i]);
+      stats_.Add(BufferPoolCounter::BACKGROUND_WRITES);
+      // Release each frame as soon as its own write is done, so an eviction waiting on it does not wait for the batch.
+      frame_id_t frame_id = batch[i].second;
+      std::scoped_lock<std::mutex> frame_lock(latch_);
+      write_in_flight_[frame_id] = false;
+      io_cv_[frame_id].notify_all();
+    }
+
+    lock.lock();
+  }
+}
+
+void BufferPoolManagerInstance::StopPrefetcher() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (prefetcher_ == nullptr) {
+      return;
+    }
+    stop_prefetcher_ = true;
+    prefetch_cv_.notify_one();
+  }
+  prefetcher_->join();
+  delete prefetcher_;
+  prefetcher_ = nullptr;
+}
+
+void BufferPoolManagerInstance::PrefetcherLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [&] { return stop_prefetcher_ || !prefetch_queue_.empty(); });
+    if (prefetch_queue_.empty()) {
+      // Asked to stop, and every reserved frame has been filled.
+      break;
+    }
+    // Take all the queued reads, so that the disk scheduler can merge the adjacent ones.
+    std::vector<PrefetchRequest> requests(prefetch_queue_.begin(), prefetch_queue_.end());
+    prefetch_queue_.clear();
+    lock.unlock();
+
+    // Each frame must be written back before the page it is reserved for is read into it.
+    std::vector<std::pair<page_id_t, frame_id_t>> writes;
+    std::vector<std::pair<page_id_t, frame_id_t>> reads;
+    for (const auto &request : requests) {
+      if (request.dirty_page_id_ != INVALID_PAGE_ID) {
+        writes.emplace_back(request.dirty_page_id_, request.frame_id_);
+      }
+      reads.emplace_back(request.page_id_, request.frame_id_);
+    }
+    auto pending_writes = SubmitIo(true, writes);
+    for (auto &io : pending_writes) {
+      AwaitIo(&io);
+    }
+    auto pending_reads = SubmitIo(false, reads);
+
+    std::vector<page_id_t> dropped_views;
+    for (size_t i = 0; i < requests.size(); ++i) {
+      AwaitIo(&pending_reads[i]);
+      const PrefetchRequest &request = requests[i];
+      Page *page = &pages_[request.frame_id_];
+      std::scoped_lock<std::mutex> frame_lock(latch_);
+      FinishIo(request.frame_id_, request.dirty_page_id_);
+      // Drop the pin ReserveFrame() took on our behalf. Fetches that waited for the read pin the page themselves.
+      if (page->pin_count_.fetch_sub(1) == 1) {
+        replacer_->SetEvictable(request.frame_id_, true);
+        if (DropAdoptedView(request.page_id_)) {
+          dropped_views.push_back(request.page_id_);
+        }
+      }
+      prefetches_in_flight_--;
+      stats_.Add(BufferPoolCounter::PREFETCHED_PAGES);
+    }
+
+    for (page_id_t page_id : dropped_views) {
+      disk_manager_->ReleasePageView(page_id);
+    }
+
+    lock.lock();
+  }
+}
+
+auto BufferPoolManagerInstance::AllocatePage() -> page_id_t {
+  // A free page is not resident: it was deleted from the pool, or never fetched, before it was deallocated, and
+  // prefetches skip free pages. So it can take a frame like a fresh page.
+  page_id_t page_id = disk_manager_->AllocateFreePage(num_instances_, instance_index_);
+  if (page_id != INVALID_PAGE_ID) {
+    return page_id;
+  }
+  const page_id_t next_page_id = next_page_id_.fetch_add(num_instances_);
+  BUSTUB_ASSERT(static_cast<uint32_t>(next_page_id) % num_instances_ == instance_index_,
+                "allocated page id does not belong to this instance");
+  return next_page_id;
+}
 
 }  // namespace bustub
@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace bustub {
+
+auto BufferPoolCounterToString(BufferPoolCounter counter) -> std::string {
+  switch (counter) {
+    case BufferPoolCounter::FETCH_HITS:
+      return "fetch_hits";
+    case BufferPoolCounter::FETCH_MISSES:
+      return "fetch_misses";
+    case BufferPoolCounter::NEW_PAGES:
+      return "new_pages";
+    case BufferPoolCounter::CLEAN_EVICTIONS:
+      return "clean_evictions";
+    case BufferPoolCounter::DIRTY_EVICTIONS:
+      return "dirty_evictions";
+    case BufferPoolCounter::FAILED_EVICTIONS:
+      return "failed_evictions";
+    case BufferPoolCounter::PIN_WAITS:
+      return "pin_waits";
+    case BufferPoolCounter::FLUSHES:
+      return "flushes";
+    case BufferPoolCounter::BACKGROUND_WRITES:
+      return "background_writes";
+    case BufferPoolCounter::PREFETCHED_PAGES:
+      return "prefetched_pages";
+    case BufferPoolCounter::PAGE_VIEWS:
+      return "page_views";
+    case BufferPoolCounter::NUM_COUNTERS:
+      break;
+  }
+  return "unknown";
+}
+
+auto LatencyHistogram::operator=(const LatencyHistogram &other) -> LatencyHistogram & {
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    buckets_[i].store(other.GetBucket(i), std::memory_order_relaxed);
+  }
+  return *this;
+}
+
+auto LatencyHistogram::operator+=(const LatencyHistogram &other) -> LatencyHistogram & {
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    buckets_[i].fetch_add(other.GetBucket(i), std::memory_order_relaxed);
+  }
+  return *this;
+}
+
+void LatencyHistogram::Record(std::chrono::nanoseconds latency) {
+  auto micros = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+  // Bucket i > 0 holds [2^(i-1), 2^i), i.e. the latencies whose highest set bit is bit i - 1.
+  size_t bucket = 0;
+  while (micros != 0 && bucket < NUM_BUCKETS - 1) {
+    micros >>= 1;
+    bucket++;
+  }
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+auto LatencyHistogram::GetCount() const -> uint64_t {
+  uint64_t count = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    count += GetBucket(i);
+  }
+  return count;
+}
+
+auto LatencyHistogram::GetPercentile(double percentile) const -> uint64_t {
+  uint64_t count = GetCount();
+  if (count == 0) {
+    return 0;
+  }
+  // The rank of the latency we are looking for, counting from 1.
+  auto rank = static_cast<uint64_t>(std::ceil(percentile / 100 * static_cast<double>(count)));
+  rank = std::max<uint64_t>(rank, 1);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    seen += GetBucket(i);
+    if (seen >= rank) {
+      return GetBucketBound(i);
+    }
+  }
+  return GetBucketBound(NUM_BUCKETS - 1);
+}
+
+auto BufferPoolStats::operator=(const BufferPoolStats &other) -> BufferPoolStats & {
+  for (size_t i = 0; i < counters_.size(); ++i) {
+    counters_[i].store(other.counters_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+  read_latency_ = other.read_latency_;
+  write_latency_ = other.write_latency_;
+  return *this;
+}
+
+auto BufferPoolStats::operator+=(const BufferPoolStats &other) -> BufferPoolStats & {
+  for (size_t i = 0; i < counters_.size(); ++i) {
+    counters_[i].fetch_add(other.counters_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+  read_latency_ += other.read_latency_;
+  write_latency_ += other.write_latency_;
+  return *this;
+}
+
+}  // namespace bustub
@@ -12,18 +12,98 @@
 
 #include "buffer/clock_replacer.h"
 
+#include "common/macros.h"
+
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : num_frames_(num_pages), state_(new std::atomic<uint8_t>[num_pages]) {
+  for (size_t i = 0; i < num_frames_; i++) {
+    state_[i].store(0);
+  }
+}
+
+ClockReplacer::~ClockReplacer() { delete[] state_; }
+
+auto ClockReplacer::Evict(frame_id_t *frame_id) -> bool {
+  // Two full turns clear every reference bit, so a frame that stays evictable is found by the third.
+  for (size_t step = 0; step < 3 * num_frames_; step++) {
+    size_t i = hand_.fetch_add(1) % num_frames_;
+    uint8_t state = state_[i].load();
+    if ((state & (TRACKED | EVICTABLE)) != (TRACKED | EVICTABLE)) {
+      continue;
+    }
+    if ((state & REFERENCED) != 0) {
+      // Second chance. Losing the race to another thread is fine, it only changes this frame's bits.
+      state_[i].compare_exchange_strong(state, static_cast<uint8_t>(state & ~REFERENCED));
+      continue;
+    }
+    if (state_[i].compare_exchange_strong(state, 0)) {
+      *frame_id = static_cast<frame_id_t>(i);
+      return true;
+    }
+  }
+  return false;
+}
 
-ClockReplacer::~ClockReplacer() = default;
+void ClockReplacer::RecordAccess(frame_id_t frame_id) {
+  BUSTUB_ASSERT((size_t)frame_id < num_frames_, "frame id is invalid");
+  state_[frame_id].fetch_or(TRACKED | REFERENCED);
+}
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  BUSTUB_ASSERT((size_t)frame_id < num_frames_, "frame id is invalid");
+  uint8_t state = state_[frame_id].load();
+  while (true) {
+    if ((state & TRACKED) == 0 || ((state & EVICTABLE) != 0) == set_evictable) {
+      return;
+    }
+    auto desired = static_cast<uint8_t>(set_evictable ? (state | EVICTABLE) : (state & ~EVICTABLE));
+    if (state_[frame_id].compare_exchange_weak(state, desired)) {
+      return;
+    }
+  }
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  BUSTUB_ASSERT((size_t)frame_id < num_frames_, "frame id is invalid");
+  uint8_t state = state_[frame_id].load();
+  while (true) {
+    if ((state & TRACKED) == 0) {
+      return;
+    }
+    BUSTUB_ASSERT((state & EVICTABLE) != 0, "frame can't be removed");
+    if (state_[frame_id].compare_exchange_weak(state, 0)) {
+      return;
+    }
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+auto ClockReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  // Frames without a reference bit go first, in hand order, then the ones that would get a second chance.
+  std::vector<frame_id_t> ret;
+  size_t start = hand_.load();
+  for (uint8_t referenced : {static_cast<uint8_t>(0), REFERENCED}) {
+    for (size_t step = 0; step < num_frames_ && ret.size() < max_count; step++) {
+      size_t i = (start + step) % num_frames_;
+      uint8_t state = state_[i].load();
+      if ((state & (TRACKED | EVICTABLE | REFERENCED)) == (TRACKED | EVICTABLE | referenced)) {
+        ret.push_back(static_cast<frame_id_t>(i));
+      }
+    }
+  }
+  return ret;
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+auto ClockReplacer::Size() -> size_t {
+  // Derived from the frame states rather than kept in a separate counter, which could not be updated in the same CAS
+  // as the state and would be off while another thread is between the two.
+  size_t size = 0;
+  for (size_t i = 0; i < num_frames_; i++) {
+    if ((state_[i].load() & (TRACKED | EVICTABLE)) == (TRACKED | EVICTABLE)) {
+      size++;
+    }
+  }
+  return size;
+}
 
 }  // namespace bustub
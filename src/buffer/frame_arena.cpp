@@ -0,0 +1,44 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+#include <cstdint>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+FrameArena::FrameArena(size_t num_frames, bool huge_pages) {
+  size_t size = num_frames * BUSTUB_PAGE_SIZE;
+  // Map an extra huge page, so that the slots can start on a huge page boundary.
+  mapping_size_ = huge_pages ? size + HUGE_PAGE_SIZE : size;
+  void *mapping =
+      mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (mapping == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map buffer pool memory");
+  }
+  mapping_ = static_cast<char *>(mapping);
+  base_ = mapping_;
+  if (huge_pages) {
+    auto address = reinterpret_cast<uintptr_t>(mapping_);
+    base_ = mapping_ + (HUGE_PAGE_SIZE - address % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+    huge_pages_ = madvise(base_, size, MADV_HUGEPAGE) == 0;
+  }
+}
+
+FrameArena::~FrameArena() { munmap(mapping_, mapping_size_); }
+
+void FrameArena::Release(frame_id_t frame_id) { madvise(GetFrame(frame_id), BUSTUB_PAGE_SIZE, MADV_DONTNEED); }
+
+}  // namespace bustub
@@ -15,124 +15,167 @@
 namespace bustub {
 
 LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k)
-    : record_pair_(new std::pair<frame_id_t, std::deque<TimePoint>>[num_frames]),
-      evictable_tag_(new bool[num_frames]),
-      replacer_size_(num_frames),
-      k_(k) {
-  for (size_t i = 0; i < num_frames; i++) {
-    evictable_tag_[i] = false;
-    record_pair_[i].first = -1;
-    record_pair_[i].second.clear();
-  }
+    : frames_(new FrameInfo[num_frames]), history_(new uint64_t[num_frames * k]), replacer_size_(num_frames), k_(k) {
+  BUSTUB_ASSERT(k > 0, "k must be positive");
 }
 
 LRUKReplacer::~LRUKReplacer() {
-  delete[] record_pair_;
-  delete[] evictable_tag_;
+  delete[] frames_;
+  delete[] history_;
+}
+
+void LRUKReplacer::PushHistory(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  uint64_t *ring = history_ + frame_id * k_;
+  if (info.count_ < k_) {
+    ring[(info.head_ + info.count_) % k_] = current_timestamp_++;
+    info.count_++;
+  } else {
+    ring[info.head_] = current_timestamp_++;
+    info.head_ = (info.head_ + 1) % k_;
+  }
+}
+
+void LRUKReplacer::LinkInf(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  info.prev_ = inf_tail_;
+  info.next_ = INVALID_FRAME_ID;
+  if (inf_tail_ == INVALID_FRAME_ID) {
+    inf_head_ = frame_id;
+  } else {
+    frames_[inf_tail_].next_ = frame_id;
+  }
+  inf_tail_ = frame_id;
+}
+
+void LRUKReplacer::UnlinkInf(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  if (info.prev_ == INVALID_FRAME_ID) {
+    inf_head_ = info.next_;
+  } else {
+    frames_[info.prev_].next_ = info.next_;
+  }
+  if (info.next_ == INVALID_FRAME_ID) {
+    inf_tail_ = info.prev_;
+  } else {
+    frames_[info.next_].prev_ = info.prev_;
+  }
+  info.prev_ = INVALID_FRAME_ID;
+  info.next_ = INVALID_FRAME_ID;
+}
+
+void LRUKReplacer::Forget(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  if (info.count_ < k_) {
+    UnlinkInf(frame_id);
+  } else {
+    finite_.erase({OldestAccess(frame_id), frame_id});
+  }
+  info.count_ = 0;
+  info.head_ = 0;
+  info.evictable_ = false;
+  curr_size_--;
 }
 
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
-  latch_.lock();
-  bool flag = false;
-  int index = 0;
-  std::chrono::nanoseconds max_duration = std::chrono::nanoseconds::min();
-  TimePoint min_inf_timestamp = TimePoint::max();
-  TimePoint current_time = std::chrono::high_resolution_clock::now();
-  for (size_t i = 0; i < replacer_size_; i++) {
-    if (evictable_tag_[i]) {
-      if (record_pair_[i].second.size() < k_) {
-        if (record_pair_[i].second.front() < min_inf_timestamp) {
-          min_inf_timestamp = record_pair_[i].second.front();
-          *frame_id = record_pair_[i].first;
-          index = i;
-        }
-      } else {
-        if (min_inf_timestamp == TimePoint::max()) {
-          if (max_duration < current_time - record_pair_[i].second.front()) {
-            max_duration = current_time - record_pair_[i].second.front();
-            *frame_id = record_pair_[i].first;
-            index = i;
-          }
-        }
-      }
-      flag = true;
-    }
+  std::scoped_lock<std::mutex> lock(latch_);
+  // +inf frames first, in order of first access; they all precede any frame with a finite distance.
+  frame_id_t victim = inf_head_;
+  while (victim != INVALID_FRAME_ID && !frames_[victim].evictable_) {
+    victim = frames_[victim].next_;
   }
-  if (flag) {
-    evictable_tag_[index] = false;
-    record_pair_[index].first = -1;
-    record_pair_[index].second.clear();
-    curr_size_--;
+  if (victim == INVALID_FRAME_ID) {
+    if (finite_.empty()) {
+      return false;
+    }
+    victim = finite_.begin()->second;
   }
-  latch_.unlock();
-  return flag;
+  Forget(victim);
+  *frame_id = victim;
+  return true;
 }
 
 void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
   BUSTUB_ASSERT((size_t)frame_id < replacer_size_, "frame id is invalid");
-  latch_.lock();
-  bool flag = false;
-  TimePoint current_time = std::chrono::high_resolution_clock::now();
-  for (size_t i = 0; i < replacer_size_; i++) {
-    if (record_pair_[i].first == frame_id) {
-      if (record_pair_[i].second.size() < k_) {
-        record_pair_[i].second.push_back(current_time);
-      } else {
-        record_pair_[i].second.pop_front();
-        record_pair_[i].second.push_back(current_time);
-      }
-      flag = true;
+  std::scoped_lock<std::mutex> lock(latch_);
+  FrameInfo &info = frames_[frame_id];
+  if (info.count_ == 0) {
+    PushHistory(frame_id);
+    if (k_ == 1) {
+      return;
     }
+    LinkInf(frame_id);
+    return;
   }
-  if (!flag) {
-    for (size_t i = 0; i < replacer_size_; i++) {
-      if (record_pair_[i].first == -1) {
-        record_pair_[i].first = frame_id;
-        record_pair_[i].second.push_back(current_time);
-        break;
+  if (info.count_ < k_) {
+    PushHistory(frame_id);
+    if (info.count_ == k_) {
+      // The frame now has a finite backward k-distance.
+      UnlinkInf(frame_id);
+      if (info.evictable_) {
+        finite_.emplace(OldestAccess(frame_id), frame_id);
       }
     }
+    return;
+  }
+  if (info.evictable_) {
+    finite_.erase({OldestAccess(frame_id), frame_id});
+    PushHistory(frame_id);
+    finite_.emplace(OldestAccess(frame_id), frame_id);
+  } else {
+    PushHistory(frame_id);
   }
-  latch_.unlock();
 }
 
 void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
-  latch_.lock();
-  // LOG_DEBUG("before set curr_size_ is %d", (int)curr_size_);
   BUSTUB_ASSERT((size_t)frame_id < replacer_size_, "frame id is invalid");
-  for (size_t i = 0; i < replacer_size_; i++) {
-    if (record_pair_[i].first == frame_id) {
-      if (evictable_tag_[i] && !set_evictable) {
-        curr_size_--;
-      } else if (!evictable_tag_[i] && set_evictable) {
-        curr_size_++;
-      }
-      evictable_tag_[i] = set_evictable;
+  std::scoped_lock<std::mutex> lock(latch_);
+  FrameInfo &info = frames_[frame_id];
+  if (info.count_ == 0 || info.evictable_ == set_evictable) {
+    return;
+  }
+  info.evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+  if (info.count_ == k_) {
+    if (set_evictable) {
+      finite_.emplace(OldestAccess(frame_id), frame_id);
+    } else {
+      finite_.erase({OldestAccess(frame_id), frame_id});
     }
   }
-  // LOG_DEBUG("curr_size_ is %d", (int)curr_size_);
-  latch_.unlock();
 }
 
 void LRUKReplacer::Remove(frame_id_t frame_id) {
-  latch_.lock();
-  for (size_t i = 0; i < replacer_size_; i++) {
-    if (record_pair_[i].first == frame_id) {
-      BUSTUB_ASSERT(evictable_tag_[i], "frame can't be removed");
-      evictable_tag_[i] = false;
-      record_pair_[i].first = -1;
-      record_pair_[i].second.clear();
-      curr_size_--;
+  BUSTUB_ASSERT((size_t)frame_id < replacer_size_, "frame id is invalid");
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (frames_[frame_id].count_ == 0) {
+    return;
+  }
+  BUSTUB_ASSERT(frames_[frame_id].evictable_, "frame can't be removed");
+  Forget(frame_id);
+}
+
+auto LRUKReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<frame_id_t> ret;
+  for (frame_id_t f = inf_head_; f != INVALID_FRAME_ID && ret.size() < max_count; f = frames_[f].next_) {
+    if (frames_[f].evictable_) {
+      ret.push_back(f);
     }
   }
-  latch_.unlock();
+  for (auto it = finite_.begin(); it != finite_.end() && ret.size() < max_count; ++it) {
+    ret.push_back(it->second);
+  }
+  return ret;
 }
 
 auto LRUKReplacer::Size() -> size_t {
-  latch_.lock();
-  size_t ret = curr_size_;
-  latch_.unlock();
-  return ret;
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
 }
 
 }  // namespace bustub
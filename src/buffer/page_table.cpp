@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) : capacity_(4), shift_(62) {
+  while (capacity_ < 2 * num_frames) {
+    capacity_ <<= 1;
+    shift_--;
+  }
+  slots_ = new std::atomic<uint64_t>[capacity_];
+  for (size_t i = 0; i < capacity_; i++) {
+    slots_[i].store(EMPTY);
+  }
+}
+
+PageTable::~PageTable() { delete[] slots_; }
+
+auto PageTable::Home(page_id_t page_id) const -> size_t {
+  // Page ids are dense and, in a parallel pool, strided; multiplicative hashing spreads both over the table.
+  return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >> shift_;
+}
+
+auto PageTable::Locate(page_id_t page_id) const -> size_t {
+  for (size_t i = Home(page_id), probes = 0; probes < capacity_; i = (i + 1) & (capacity_ - 1), probes++) {
+    uint64_t slot = slots_[i].load();
+    if (slot == EMPTY) {
+      break;
+    }
+    if (PageOf(slot) == page_id) {
+      return i;
+    }
+  }
+  return capacity_;
+}
+
+auto PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const -> bool {
+  size_t i = Locate(page_id);
+  if (i == capacity_) {
+    return false;
+  }
+  uint64_t slot = slots_[i].load();
+  // The entry may have been shifted away since Locate() saw it.
+  if (slot == EMPTY || PageOf(slot) != page_id) {
+    return false;
+  }
+  *frame_id = FrameOf(slot);
+  return true;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "cannot insert the invalid page id");
+  size_t i = Home(page_id);
+  for (size_t probes = 0; probes < capacity_; i = (i + 1) & (capacity_ - 1), probes++) {
+    uint64_t slot = slots_[i].load();
+    BUSTUB_ASSERT(slot == EMPTY || PageOf(slot) != page_id, "page is already in the page table");
+    if (slot == EMPTY) {
+      slots_[i].store(Pack(page_id, frame_id));
+      return;
+    }
+  }
+  UNREACHABLE("page table is full");
+}
+
+auto PageTable::Remove(page_id_t page_id) -> bool {
+  size_t hole = Locate(page_id);
+  if (hole == capacity_) {
+    return false;
+  }
+  // Backward-shift deletion: move every later entry of the probe run that may not sit behind the hole into it, so
+  // that lookups never stop early at the hole.
+  const size_t mask = capacity_ - 1;
+  for (size_t i = (hole + 1) & mask;; i = (i + 1) & mask) {
+    uint64_t slot = slots_[i].load();
+    if (slot == EMPTY) {
+      break;
+    }
+    size_t home = Home(PageOf(slot));
+    // The entry at i can fill the hole unless its home lies cyclically in (hole, i].
+    bool stays = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+    if (!stays) {
+      slots_[hole].store(slot);
+      hole = i;
+    }
+  }
+  slots_[hole].store(EMPTY);
+  return true;
+}
+
+}  // namespace bustub
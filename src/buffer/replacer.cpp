@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer.cpp
+//
+// Identification: src/buffer/replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/replacer.h"
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/two_queue_replacer.h"
+#include "common/exception.h"
+
+namespace bustub {
+
+auto MakeReplacer(ReplacerPolicy policy, size_t num_frames, size_t k) -> Replacer * {
+  switch (policy) {
+    case ReplacerPolicy::LRU_K:
+      return new LRUKReplacer(num_frames, k);
+    case ReplacerPolicy::LRU:
+      return new LRUReplacer(num_frames);
+    case ReplacerPolicy::CLOCK:
+      return new ClockReplacer(num_frames);
+    case ReplacerPolicy::TWO_QUEUE:
+      return new TwoQueueReplacer(num_frames);
+    case ReplacerPolicy::ARC:
+      return new ARCReplacer(num_frames);
+  }
+  throw Exception("unknown replacer policy");
+}
+
+auto ParseReplacerPolicy(const std::string &name, ReplacerPolicy *policy) -> bool {
+  for (auto candidate : {ReplacerPolicy::LRU_K, ReplacerPolicy::LRU, ReplacerPolicy::CLOCK, ReplacerPolicy::TWO_QUEUE,
+                         ReplacerPolicy::ARC}) {
+    if (name == ReplacerPolicyToString(candidate)) {
+      *policy = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+auto ReplacerPolicyToString(ReplacerPolicy policy) -> std::string {
+  switch (policy) {
+    case ReplacerPolicy::LRU_K:
+      return "lru_k";
+    case ReplacerPolicy::LRU:
+      return "lru";
+    case ReplacerPolicy::CLOCK:
+      return "clock";
+    case ReplacerPolicy::TWO_QUEUE:
+      return "2q";
+    case ReplacerPolicy::ARC:
+      return "arc";
+  }
+  return "unknown";
+}
+
+}  // namespace bustub
@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.cpp
+//
+// Identification: src/buffer/two_queue_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+TwoQueueReplacer::TwoQueueReplacer(size_t num_frames)
+    : num_frames_(num_frames),
+      kin_(std::max<size_t>(num_frames / 4, 1)),
+      frames_(num_frames),
+      a1out_(std::max<size_t>(num_frames / 2, 1)) {}
+
+void TwoQueueReplacer::Forget(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  if (info.evictable_) {
+    curr_size_--;
+  }
+  if (info.queue_ != Queue::NONE) {
+    ListOf(info.queue_).erase(info.pos_);
+  }
+  info = FrameInfo();
+}
+
+auto TwoQueueReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  Queue order[2] = {Queue::AM, Queue::A1IN};
+  if (PreferA1in()) {
+    std::swap(order[0], order[1]);
+  }
+  for (Queue queue : order) {
+    for (frame_id_t candidate : ListOf(queue)) {
+      if (!frames_[candidate].evictable_) {
+        continue;
+      }
+      if (queue == Queue::A1IN && frames_[candidate].page_id_ != INVALID_PAGE_ID) {
+        a1out_.Push(frames_[candidate].page_id_);
+      }
+      Forget(candidate);
+      *frame_id = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+void TwoQueueReplacer::RecordLoad(frame_id_t frame_id, page_id_t page_id) {
+  BUSTUB_ASSERT((size_t)frame_id < num_frames_, "frame id is invalid");
+  std::scoped_lock<std::mutex> lock(latch_);
+  FrameInfo &info = frames_[frame_id];
+  info.page_id_ = page_id;
+  info.hot_ = a1out_.Erase(page_id);
+}
+
+void TwoQueueReplacer::RecordAccess(frame_id_t frame_id) {
+  BUSTUB_ASSERT((size_t)frame_id < num_frames_, "frame id is invalid");
+  std::scoped_lock<std::mutex> lock(latch_);
+  FrameInfo &info = frames_[frame_id];
+  switch (info.queue_) {
+    case Queue::NONE:
+      info.queue_ = info.hot_ ? Queue::AM : Queue::A1IN;
+      ListOf(info.queue_).push_back(frame_id);
+      info.pos_ = std::prev(ListOf(info.queue_).end());
+      break;
+    case Queue::AM:
+      am_.splice(am_.end(), am_, info.pos_);
+      break;
+    case Queue::A1IN:
+      // Accesses while in A1in are correlated with the first one; they do not make the page hot.
+      break;
+  }
+}
+
+void TwoQueueReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  BUSTUB_ASSERT((size_t)frame_id < num_frames_, "frame id is invalid");
+  std::scoped_lock<std::mutex> lock(latch_);
+  FrameInfo &info = frames_[frame_id];
+  if (info.queue_ == Queue::NONE || info.evictable_ == set_evictable) {
+    return;
+  }
+  info.evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void TwoQueueReplacer::Remove(frame_id_t frame_id) {
+  BUSTUB_ASSERT((size_t)frame_id < num_frames_, "frame id is invalid");
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (frames_[frame_id].queue_ == Queue::NONE) {
+    return;
+  }
+  BUSTUB_ASSERT(frames_[frame_id].evictable_, "frame can't be removed");
+  Forget(frame_id);
+}
+
+auto TwoQueueReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  // Approximation: assumes the queue Evict() prefers right now stays preferred until it runs dry.
+  Queue order[2] = {Queue::AM, Queue::A1IN};
+  if (PreferA1in()) {
+    std::swap(order[0], order[1]);
+  }
+  std::vector<frame_id_t> ret;
+  for (Queue queue : order) {
+    for (auto it = ListOf(queue).begin(); it != ListOf(queue).end() && ret.size() < max_count; ++it) {
+      if (frames_[*it].evictable_) {
+        ret.push_back(*it);
+      }
+    }
+  }
+  return ret;
+}
+
+auto TwoQueueReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
+}
+
+}  // namespace bustub
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <optional>
 #include <shared_mutex>
+#include <stdexcept>
 #include <string>
 #include <tuple>
 
@@ -33,6 +35,7 @@
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_mmap.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -41,19 +44,28 @@ auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<Ex
   return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
 }
 
-BustubInstance::BustubInstance(const std::string &db_file_name) {
+BustubInstance::BustubInstance(const std::string &db_file_name, ReplacerPolicy replacer_policy, size_t pool_size,
+                               size_t max_pool_size, bool direct_io, bool mmap_reads) {
   enable_logging = false;
 
   // Storage related.
-  disk_manager_ = new DiskManager(db_file_name);
+  if (mmap_reads) {
+    disk_manager_ = new DiskManagerMmap(db_file_name);
+  } else {
+    disk_manager_ = new DiskManager(db_file_name, direct_io);
+  }
 
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
 
-  // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
+  // We need more frames for GenerateTestTable to work. Therefore, we default to BUSTUB_INSTANCE_POOL_SIZE instead of
+  // the default buffer pool size specified in `config.h`.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager_, LRUK_REPLACER_K, log_manager_, replacer_policy,
+                                              max_pool_size);
+    // Keep some clean victims around so that misses rarely have to write a dirty page back first.
+    bpm->RunBackgroundWriter(pool_size / 8, pool_size / 4);
+    buffer_pool_manager_ = bpm;
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -73,7 +85,7 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
 }
 
-BustubInstance::BustubInstance() {
+BustubInstance::BustubInstance(size_t pool_size, size_t max_pool_size) {
   enable_logging = false;
 
   // Storage related.
@@ -82,10 +94,11 @@ BustubInstance::BustubInstance() {
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
 
-  // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
+  // We need more frames for GenerateTestTable to work. Therefore, we default to BUSTUB_INSTANCE_POOL_SIZE instead of
+  // the default buffer pool size specified in `config.h`.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ = new BufferPoolManagerInstance(pool_size, disk_manager_, LRUK_REPLACER_K, log_manager_,
+                                                         ReplacerPolicy::LRU_K, max_pool_size);
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -146,6 +159,71 @@ void BustubInstance::CmdDisplayIndices(ResultWriter &writer) {
   writer.EndTable();
 }
 
+void BustubInstance::CmdDisplayBufferPoolStats(ResultWriter &writer) {
+  if (buffer_pool_manager_ == nullptr) {
+    WriteOneCell("There is no buffer pool.", writer);
+    return;
+  }
+  auto stats = buffer_pool_manager_->GetStats();
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("name");
+  writer.WriteHeaderCell("value");
+  writer.EndHeader();
+  auto write_row = [&writer](const std::string &name, uint64_t value) {
+    writer.BeginRow();
+    writer.WriteCell(name);
+    writer.WriteCell(fmt::format("{}", value));
+    writer.EndRow();
+  };
+  write_row("pool_size", buffer_pool_manager_->GetPoolSize());
+  for (size_t i = 0; i < static_cast<size_t>(BufferPoolCounter::NUM_COUNTERS); ++i) {
+    auto counter = static_cast<BufferPoolCounter>(i);
+    write_row(BufferPoolCounterToString(counter), stats.Get(counter));
+  }
+  for (const auto &[name, histogram] : {std::make_pair("read", &stats.GetReadLatency()),
+                                        std::make_pair("write", &stats.GetWriteLatency())}) {
+    write_row(fmt::format("{}_count", name), histogram->GetCount());
+    for (int percentile : {50, 99, 100}) {
+      write_row(fmt::format("{}_p{}_us", name, percentile), histogram->GetPercentile(percentile));
+    }
+  }
+  writer.EndTable();
+}
+
+void BustubInstance::CmdResizeBufferPool(const std::string &arg, ResultWriter &writer) {
+  if (buffer_pool_manager_ == nullptr) {
+    WriteOneCell("There is no buffer pool.", writer);
+    return;
+  }
+  size_t pool_size = 0;
+  try {
+    size_t parsed = 0;
+    pool_size = std::stoul(arg, &parsed);
+    if (arg.find_first_not_of(' ', parsed) != std::string::npos) {
+      throw std::invalid_argument(arg);
+    }
+  } catch (std::exception &e) {
+    WriteOneCell(fmt::format("Invalid pool size:{}", arg), writer);
+    return;
+  }
+  auto *bpm = dynamic_cast<BufferPoolManagerInstance *>(buffer_pool_manager_);
+  if (pool_size == 0 || (bpm != nullptr && pool_size > bpm->GetMaxPoolSize())) {
+    WriteOneCell("Pool size must be between 1 and the maximum pool size.", writer);
+    return;
+  }
+  bool resized = buffer_pool_manager_->ResizePool(pool_size);
+  WriteOneCell(fmt::format("{}: pool size is now {}", resized ? "Resized" : "Resized partially (frames are pinned)",
+                           buffer_pool_manager_->GetPoolSize()),
+               writer);
+}
+
+void BustubInstance::CmdCompactDatabase(ResultWriter &writer) {
+  size_t free_pages = disk_manager_->GetNumFreePages();
+  size_t truncated = disk_manager_->Compact();
+  WriteOneCell(fmt::format("Truncated {} pages, {} pages are free", truncated, free_pages), writer);
+}
+
 void BustubInstance::WriteOneCell(const std::string &cell, ResultWriter &writer) {
   writer.BeginTable(true);
   writer.BeginRow();
@@ -159,6 +237,9 @@ void BustubInstance::CmdDisplayHelp(ResultWriter &writer) {
 
 \dt: show all tables
 \di: show all indices
+\bpstats: show buffer pool counters and I/O latencies (upper bounds in microseconds)
+\bpresize <n>: grow or shrink the buffer pool to n frames
+\compact: truncate the free pages at the end of the database file
 \help: show this message again
 
 BusTub shell currently only supports a small set of Postgres queries. We'll set
@@ -191,6 +272,18 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       CmdDisplayIndices(writer);
       return true;
     }
+    if (sql == "\\bpstats") {
+      CmdDisplayBufferPoolStats(writer);
+      return true;
+    }
+    if (sql.rfind("\\bpresize", 0) == 0) {
+      CmdResizeBufferPool(sql.substr(std::string("\\bpresize").size()), writer);
+      return true;
+    }
+    if (sql == "\\compact") {
+      CmdCompactDatabase(writer);
+      return true;
+    }
     if (sql == "\\help") {
       CmdDisplayHelp(writer);
       return true;
@@ -205,6 +298,14 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
   binder.ParseAndSave(sql);
   l.unlock();
 
+  // A transaction that has written nothing so far and runs nothing but queries only reads, so its scans may read pages
+  // in place.
+  if (txn->GetWriteSet()->empty() && txn->GetIndexWriteSet()->empty()) {
+    txn->SetReadOnly(std::all_of(binder.statement_nodes_.begin(), binder.statement_nodes_.end(), [](auto *node) {
+      return node->type == duckdb_libpgquery::T_PGSelectStmt;
+    }));
+  }
+
   for (auto *stmt : binder.statement_nodes_) {
     auto statement = binder.BindStatement(stmt);
     switch (statement->type_) {
@@ -20,4 +20,8 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds background_writer_interval = std::chrono::milliseconds(100);
+
+bool enable_huge_pages = false;
+
 }  // namespace bustub
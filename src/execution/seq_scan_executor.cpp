@@ -12,6 +12,8 @@
 
 #include "execution/executors/seq_scan_executor.h"
 
+#include <memory>
+
 namespace bustub {
 
 SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
@@ -38,7 +40,10 @@ void SeqScanExecutor::Init() {
       }
     }
   }
-  itr_ = tree_->Begin(this->GetExecutorContext()->GetTransaction());
+  // Scan through a private ring of frames so a large table does not flush the rest of the buffer pool.
+  // A read-only transaction may also read the pages that are not in the pool in place.
+  auto *txn = this->GetExecutorContext()->GetTransaction();
+  itr_ = tree_->Begin(txn, std::make_shared<BufferAccessStrategy>(SCAN_RING_SIZE, txn->IsReadOnly()));
 }
 
 auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/ghost_list.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy (Megiddo and Modha, FAST '03).
+ *
+ * Resident pages live in T1 (seen once recently) or T2 (seen at least twice), both kept in LRU order. Evicted pages
+ * are remembered in the ghost lists B1 and B2 respectively. A page loaded while in B1 means T1 was too small, so the
+ * target size p of T1 grows; a page loaded while in B2 shrinks it. Victims come from T1 while it is larger than p, and
+ * from T2 otherwise. The result balances recency against frequency as the workload changes, and one-off scans stay in
+ * T1 without pushing the frequently used pages out of T2.
+ *
+ * As in 2Q, re-references that are correlated with the first one do not count as reuse: an access to a page in T1
+ * only moves it to T2 once correlation_window_ other pages have been loaded since it was. Otherwise a sequential scan,
+ * which fetches its current page once per tuple, would promote every page it reads to T2.
+ *
+ * Ghost hits are detected in RecordLoad(), so the replacer needs it to know which page each frame holds.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new ARCReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to track
+   */
+  explicit ARCReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ARCReplacer);
+
+  ~ARCReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void RecordLoad(frame_id_t frame_id, page_id_t page_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
+
+  auto Size() -> size_t override;
+
+  /** @return the current target size of T1, for tests and benchmarks */
+  auto GetTarget() -> size_t;
+
+ private:
+  enum class Queue { NONE, T1, T2 };
+
+  struct FrameInfo {
+    Queue queue_{Queue::NONE};
+    std::list<frame_id_t>::iterator pos_;
+    bool evictable_{false};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    /** The page was found in a ghost list when loaded, so it goes straight to T2. */
+    bool hot_{false};
+    /** Value of loads_ when the page was loaded. */
+    size_t load_seq_{0};
+  };
+
+  auto PreferT1() const -> bool { return !t1_.empty() && t1_.size() > p_; }
+  auto ListOf(Queue queue) -> std::list<frame_id_t> & { return queue == Queue::T1 ? t1_ : t2_; }
+  /** Drop all state of a tracked frame. */
+  void Forget(frame_id_t frame_id);
+  /** Keep |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c. */
+  void TrimGhosts();
+
+  /** c, the number of frames. */
+  size_t num_frames_;
+  /** p, the target size of T1. */
+  size_t p_{0};
+  /** Number of other pages that must be loaded before a re-reference to a T1 page counts as reuse. */
+  size_t correlation_window_;
+  /** Number of pages loaded so far. */
+  size_t loads_{0};
+  std::vector<FrameInfo> frames_;
+  /** Least recently used first. */
+  std::list<frame_id_t> t1_;
+  std::list<frame_id_t> t2_;
+  GhostList b1_;
+  GhostList b2_;
+  size_t curr_size_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
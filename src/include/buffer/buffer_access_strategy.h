@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * BufferAccessStrategy lets a sequential scan (or another bulk operation) cycle through a small private ring of frames
+ * instead of pulling every page it reads through the shared replacement policy.
+ *
+ * The strategy remembers the last ring_size pages it made the buffer pool load. Once the ring is full, a miss reuses
+ * the frame of the oldest of those pages that is still resident and unpinned, so the scan keeps roughly ring_size
+ * frames of the pool no matter how large the table is, and never evicts pages that other queries depend on. Hits are
+ * served from the pool as usual.
+ *
+ * A read-only strategy also lets the buffer pool serve the pages that are not resident in place, if the disk manager
+ * can hand out page views (see DiskManagerMmap): such pages take no frame at all and are not copied.
+ *
+ * A strategy belongs to one scan and is not thread-safe; the buffer pool only touches it under its own latch, on
+ * behalf of the thread running the scan.
+ */
+class BufferAccessStrategy {
+ public:
+  /**
+   * @brief Create a new ring of ring_size frames.
+   * @param ring_size the number of frames the scan may occupy before it starts reusing its own
+   * @param read_only true if the scan never modifies the pages it fetches, so they may be read in place
+   */
+  explicit BufferAccessStrategy(size_t ring_size = SCAN_RING_SIZE, bool read_only = false)
+      : ring_size_(ring_size), read_only_(read_only) {
+    BUSTUB_ASSERT(ring_size > 0, "a ring needs at least one frame");
+  }
+
+  DISALLOW_COPY_AND_MOVE(BufferAccessStrategy);
+
+  /** @return true once the scan has loaded ring_size pages, i.e. misses should reuse ring frames */
+  auto IsFull() const -> bool { return ring_.size() >= ring_size_; }
+
+  /** @brief Remember that the scan made the buffer pool load page_id, forgetting the oldest page beyond the ring. */
+  void Push(page_id_t page_id) {
+    ring_.push_back(page_id);
+    while (ring_.size() > ring_size_) {
+      ring_.pop_front();
+    }
+  }
+
+  /** @return the pages of the ring, oldest first; the buffer pool erases the ones it reuses or no longer holds */
+  auto GetRing() -> std::deque<page_id_t> & { return ring_; }
+
+  /** @return the number of frames in the ring */
+  auto GetRingSize() const -> size_t { return ring_size_; }
+
+  /** @return true if the pages the scan fetches may be read in place */
+  auto IsReadOnly() const -> bool { return read_only_; }
+
+ private:
+  size_t ring_size_;
+  bool read_only_;
+  std::deque<page_id_t> ring_;
+};
+
+}  // namespace bustub
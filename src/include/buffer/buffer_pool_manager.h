@@ -16,6 +16,8 @@
 #include <mutex>  // NOLINT
 #include <unordered_map>
 
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_stats.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
@@ -45,6 +47,27 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * @brief Fetch a page on behalf of a scan that reads through a ring of frames, see BufferAccessStrategy.
+   * @param page_id id of page to be fetched
+   * @param strategy the scan's strategy, nullptr to fetch like FetchPage()
+   * @return the requested page, nullptr if it could not be fetched
+   */
+  auto FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * { return FetchPgImp(page_id, strategy); }
+
+  /**
+   * @brief Hint that the pages [first_page_id, first_page_id + count) will be fetched soon. Pages that are not
+   * resident yet are read into the buffer pool in the background, unpinned, so a later FetchPage() finds them there
+   * or waits only for the rest of the read. This never blocks on disk I/O, and pages that cannot be prefetched right
+   * now (no free or evictable frame, not allocated yet, ...) are silently skipped.
+   * @param first_page_id id of the first page to prefetch
+   * @param count number of consecutive page ids to prefetch
+   * @param strategy the ring of the scan the pages are read for, or nullptr
+   */
+  void PrefetchPages(page_id_t first_page_id, size_t count, BufferAccessStrategy *strategy = nullptr) {
+    PrefetchPgsImp(first_page_id, count, strategy);
+  }
+
   /** Grading function. Do not modify! */
   auto UnpinPage(page_id_t page_id, bool is_dirty, bufferpool_callback_fn callback = nullptr) -> bool {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -87,6 +110,17 @@ class BufferPoolManager {
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
+  /**
+   * @brief Grow or shrink the buffer pool while it is in use. Buffer pools that cannot be resized only accept their
+   * current size.
+   * @param pool_size the new number of frames
+   * @return true if the pool now has pool_size frames
+   */
+  virtual auto ResizePool(size_t pool_size) -> bool { return pool_size == GetPoolSize(); }
+
+  /** @return a snapshot of the counters and I/O latencies of the buffer pool; all zero if it keeps none */
+  virtual auto GetStats() -> BufferPoolStats { return {}; }
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -108,6 +142,24 @@ class BufferPoolManager {
    */
   virtual auto FetchPgImp(page_id_t page_id) -> Page * = 0;
 
+  /**
+   * Fetch the requested page from the buffer pool, taking the frame for a miss from the strategy's ring if it can.
+   * Buffer pools without ring support fetch like FetchPgImp(page_id).
+   * @param page_id id of page to be fetched
+   * @param strategy the scan's strategy, may be nullptr
+   * @return the requested page
+   */
+  virtual auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * { return FetchPgImp(page_id); }
+
+  /**
+   * Start reading the given pages into the buffer pool in the background. Buffer pools without read-ahead ignore the
+   * hint.
+   * @param first_page_id id of the first page to prefetch
+   * @param count number of consecutive page ids to prefetch
+   * @param strategy the scan's strategy, may be nullptr
+   */
+  virtual void PrefetchPgsImp(page_id_t first_page_id, size_t count, BufferAccessStrategy *strategy) {}
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
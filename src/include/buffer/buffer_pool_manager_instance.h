@@ -12,16 +12,28 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
 #include <list>
-#include <mutex>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/frame_arena.h"
 #include "buffer/lru_k_replacer.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
-#include "container/hash/extendible_hash_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
 #include "storage/page/page.h"
 
 namespace bustub {
@@ -37,9 +49,29 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_policy the replacement policy
+   * @param max_pool_size the size ResizePool() may grow the pool to; smaller values mean pool_size
    */
   BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerPolicy replacer_policy = ReplacerPolicy::LRU_K,
+                            size_t max_pool_size = 0);
+
+  /**
+   * @brief Creates a new BufferPoolManagerInstance that is one shard of a ParallelBufferPoolManager.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of BPIs in the parallel BPM
+   * @param instance_index index of this BPI in the parallel BPM; it only allocates page ids with
+   * (page_id % num_instances == instance_index)
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_policy the replacement policy
+   * @param max_pool_size the size ResizePool() may grow the pool to; smaller values mean pool_size
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
+                            LogManager *log_manager = nullptr, ReplacerPolicy replacer_policy = ReplacerPolicy::LRU_K,
+                            size_t max_pool_size = 0);
 
   /**
    * @brief Destroy an existing BufferPoolManagerInstance.
@@ -49,9 +81,57 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @brief Return the size (number of frames) of the buffer pool. */
   auto GetPoolSize() -> size_t override { return pool_size_; }
 
-  /** @brief Return the pointer to all the pages in the buffer pool. */
+  /** @brief Return the largest size ResizePool() can grow the pool to. */
+  auto GetMaxPoolSize() const -> size_t { return max_pool_size_; }
+
+  /**
+   * @brief Return the pointer to all the pages in the buffer pool. Frames that are not in use (see ResizePool()) have
+   * no page and no data.
+   */
   auto GetPages() -> Page * { return pages_; }
 
+  /**
+   * @brief Grow or shrink the pool to pool_size frames while it is in use.
+   *
+   * Growing gives frames a page buffer and adds them to the free list. Shrinking takes frames from the free list
+   * first, then evicts evictable frames in the order the replacer picks them (writing dirty pages back), and releases
+   * their page buffers. Pinned frames are never taken, so a shrink stops early if too many frames are pinned.
+   *
+   * @param pool_size the new number of frames, in [1, GetMaxPoolSize()]
+   * @return false if the pool could only shrink part of the way because the remaining frames are pinned
+   */
+  auto ResizePool(size_t pool_size) -> bool override;
+
+  /**
+   * @brief Start the background writer thread.
+   *
+   * The writer wakes up every interval, or as soon as an eviction had to write a dirty victim. When
+   * fewer than low_watermark frames are free or clean and evictable, it writes back dirty evictable frames in the
+   * order the replacer would evict them, until high_watermark frames are clean. Each batch is written in page id
+   * order so that neighbouring pages reach the disk together.
+   *
+   * @param low_watermark number of clean victims below which the writer starts cleaning
+   * @param high_watermark number of clean victims the writer cleans up to
+   * @param interval how long the writer sleeps between checks
+   */
+  void RunBackgroundWriter(size_t low_watermark, size_t high_watermark,
+                           std::chrono::milliseconds interval = background_writer_interval);
+
+  /** @brief Stop and join the background writer thread, if it is running. */
+  void StopBackgroundWriter();
+
+  /** @return the number of evictions whose victim was clean and could be reused without a write */
+  auto GetNumCleanEvictions() const -> size_t { return stats_.Get(BufferPoolCounter::CLEAN_EVICTIONS); }
+
+  /** @return the number of evictions that had to write a dirty victim back first */
+  auto GetNumDirtyEvictions() const -> size_t { return stats_.Get(BufferPoolCounter::DIRTY_EVICTIONS); }
+
+  /** @return the number of pages the prefetcher has read into the buffer pool */
+  auto GetNumPrefetchedPages() const -> size_t { return stats_.Get(BufferPoolCounter::PREFETCHED_PAGES); }
+
+  /** @brief Return a snapshot of the counters and I/O latencies of this instance. */
+  auto GetStats() -> BufferPoolStats override { return stats_; }
+
  protected:
   /**
    * TODO(P1): Add implementation
@@ -90,6 +170,35 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto FetchPgImp(page_id_t page_id) -> Page * override;
 
+  /**
+   * @brief Fetch the requested page like FetchPgImp(page_id), except that a miss reuses a frame of the strategy's ring
+   * once the ring is full. The frame is taken from the oldest ring page of this instance that is resident and
+   * unpinned; if there is none, the miss falls back to the free list and the replacer.
+   *
+   * A miss of a read-only strategy is served in place instead if the disk manager can hand out a view of the page: the
+   * returned page is not in a frame, its data must not be modified, and it is unpinned by id like any other. If the
+   * page is loaded into a frame while it has such readers, the frame takes over their pins, and keeps the view alive
+   * until its last pin is gone.
+   *
+   * @param page_id id of page to be fetched
+   * @param strategy the scan's strategy, nullptr to fetch normally
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * @brief Reserve frames for the pages in [first_page_id, first_page_id + count) that belong to this instance, are
+   * allocated, and are neither resident nor being written back, and hand their reads to the prefetcher thread. The
+   * frames are reserved like for a miss of FetchPgImp(page_id, strategy), so a fetch of a page that is still loading
+   * waits for it. At most max(1, pool_size / 4) prefetches are in flight; the rest of the range is skipped. Nothing is
+   * prefetched for a read-only strategy whose pages are read in place.
+   *
+   * @param first_page_id id of the first page to prefetch
+   * @param count number of consecutive page ids to prefetch
+   * @param strategy the scan's strategy, may be nullptr
+   */
+  void PrefetchPgsImp(page_id_t first_page_id, size_t count, BufferAccessStrategy *strategy) override;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -121,7 +230,7 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Flush all the pages in the buffer pool to disk.
+   * @brief Flush all the pages in the buffer pool to disk, and sync the disk manager so that they are durable.
    */
   void FlushAllPgsImp() override;
 
@@ -140,42 +249,229 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto DeletePgImp(page_id_t page_id) -> bool override;
 
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
+  /** Number of frames in use, changed by ResizePool() under latch_. */
+  std::atomic<size_t> pool_size_;
+  /** Number of frames the pool can hold; frame ids are below this. */
+  const size_t max_pool_size_;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
   /** The next page id to be allocated  */
   std::atomic<page_id_t> next_page_id_ = 0;
-  /** Bucket size for the extendible hash table */
-  const size_t bucket_size_ = 4;
 
   /** Array of buffer pool pages. */
   Page *pages_;
+  /** The page buffers of the frames, aligned for O_DIRECT. Retired frames give their memory back to the OS. */
+  FrameArena *arena_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. Please ignore this for P1. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  ExtendibleHashTable<page_id_t, frame_id_t> *page_table_;
+  /** Runs the I/O of the prefetcher, the background writer and FlushAllPages(), so that adjacent pages are merged. */
+  DiskScheduler *disk_scheduler_;
+  /** Page table for keeping track of buffer pool pages. Lookups are lock-free, changes are made under latch_. */
+  PageTable *page_table_;
   /** Replacer to find unpinned pages for replacement. */
-  LRUKReplacer *replacer_;
+  Replacer *replacer_;
   /** List of free frames that don't have any pages on them. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /** Frames beyond the current pool size, whose page buffers hold no memory. Protected by latch_. */
+  std::list<frame_id_t> retired_frames_;
+  /** Serializes ResizePool() calls, which release latch_ while they write back dirty pages. */
+  std::mutex resize_latch_;
+  /**
+   * This latch protects changes to the page table, the free list, the frame metadata (page id, pin count, dirty flag)
+   * and the I/O bookkeeping below. It is never held across a disk read or write.
+   *
+   * Two things happen without it: a hit on a page that is already pinned (TryPinResident()), and an unpin that is not
+   * the last one. Neither takes a pin count to or from zero, so neither changes whether the frame is evictable, and
+   * no frame is reused while either runs.
+   */
   std::mutex latch_;
+  /** True while a frame is being filled from (or written back to) disk outside of the latch. */
+  std::atomic<bool> *io_pending_;
+  /**
+   * True while the page in a frame is being flushed outside of the latch. The frame is not pinned for the flush, but
+   * it is not reused or reset until the write is done.
+   */
+  bool *write_in_flight_;
+  /** One condition variable per frame, used together with latch_ to wait for that frame's I/O to finish. */
+  std::condition_variable *io_cv_;
+  /**
+   * Pages that must not be read from disk yet, mapped to the frame whose I/O they wait for: pages evicted dirty whose
+   * write-back is still in flight, and pages whose load is waiting for a flush of the frame they will be read into.
+   */
+  std::unordered_map<page_id_t, frame_id_t> write_back_;
+  /** The background writer thread, nullptr if it is not running. */
+  std::thread *background_writer_{nullptr};
+  /** Set under latch_ to ask the background writer to exit. */
+  bool stop_background_writer_{false};
+  /** Wakes up the background writer; used together with latch_. */
+  std::condition_variable background_writer_cv_;
+  /** Background writer watermarks, see RunBackgroundWriter(). */
+  size_t low_watermark_{0};
+  size_t high_watermark_{0};
+  std::chrono::milliseconds background_writer_interval_{background_writer_interval};
+  /** Counters and I/O latencies, updated lock-free. */
+  BufferPoolStats stats_;
+
+  /** A page read in place by read-only scans, see FetchPgImp(page_id, strategy). Holds one view of the disk manager. */
+  struct PageView {
+    std::unique_ptr<Page> page_;
+    /** Pins of the readers, until the page is loaded into a frame, which then holds them instead. */
+    int pins_;
+    /** True once a frame holds the pins; the view is released when the frame's last pin is gone. */
+    bool adopted_;
+  };
+  /** The pages read in place, protected by latch_. */
+  std::unordered_map<page_id_t, PageView> views_;
+
+  /** A page read handed to the prefetcher: the frame is reserved and pinned once on its behalf. */
+  struct PrefetchRequest {
+    page_id_t page_id_;
+    frame_id_t frame_id_;
+    page_id_t dirty_page_id_;
+  };
+  /** Reads waiting for the prefetcher, protected by latch_. */
+  std::deque<PrefetchRequest> prefetch_queue_;
+  /** Number of reserved prefetch frames whose read has not finished, protected by latch_. */
+  size_t prefetches_in_flight_{0};
+  /** The prefetcher thread, started by the first PrefetchPgsImp() that has something to read. */
+  std::thread *prefetcher_{nullptr};
+  /** Set under latch_ to ask the prefetcher to exit once its queue is empty. */
+  bool stop_prefetcher_{false};
+  /** Wakes up the prefetcher; used together with latch_. */
+  std::condition_variable prefetch_cv_;
 
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Allocate a page on disk, reusing a free page of this instance if there is one. Caller should acquire the
+   * latch before calling this function.
    * @return the id of the allocated page
    */
   auto AllocatePage() -> page_id_t;
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Deallocate a page on disk, so that AllocatePage() can reuse it. Caller should acquire the latch before
+   * calling this function.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id) { disk_manager_->DeallocatePage(page_id); }
+
+  /**
+   * @brief Reserve a frame for page_id. Caller should acquire the latch before calling this function.
+   *
+   * The frame is taken from the strategy's ring first (see TakeRingFrame()), then from the free list, then from the
+   * replacer. The old page (if any) is detached with DetachVictim(), which may wait for a flush of the frame. The new
+   * mapping is installed with pin count 1 and the frame is marked as I/O pending, so the caller can release the latch
+   * and do the disk I/O.
+   *
+   * @param lock the held latch, released while waiting
+   * @param page_id id of the page that will live in the frame, or INVALID_PAGE_ID to allocate a new page once a frame
+   * is found
+   * @param strategy the ring the page is loaded for, or nullptr
+   * @param[out] frame_id the reserved frame
+   * @param[out] dirty_page_id id of the evicted page that must be written back, or INVALID_PAGE_ID
+   * @return false if all frames are pinned
+   */
+  auto ReserveFrame(std::unique_lock<std::mutex> *lock, page_id_t page_id, BufferAccessStrategy *strategy,
+                    frame_id_t *frame_id, page_id_t *dirty_page_id) -> bool;
+
+  /**
+   * @brief Detach the page of a victim frame that was just taken out of the replacer. Caller should acquire the latch.
+   *
+   * Waits for a flush of the frame to finish, removes the old page from the page table and, if it is dirty, records
+   * it in write_back_. The frame is then left for the caller to reuse.
+   *
+   * @param lock the held latch, released while waiting
+   * @param page_id the page the frame is reused for, held off while waiting; INVALID_PAGE_ID if none
+   * @param frame_id the victim frame
+   * @param[out] dirty_page_id id of the old page if it must be written back, left unchanged otherwise
+   */
+  void DetachVictim(std::unique_lock<std::mutex> *lock, page_id_t page_id, frame_id_t frame_id,
+                    page_id_t *dirty_page_id);
+
+  /**
+   * @brief Take the frame of the oldest page in the strategy's ring that belongs to this instance and is resident and
+   * unpinned, dropping ring pages that are no longer resident. Caller should acquire the latch.
+   * @param strategy the scan's strategy, may be nullptr
+   * @param[out] frame_id the frame, removed from the replacer but still holding its old page
+   * @return false if the ring is not full yet or has no reusable frame
+   */
+  auto TakeRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id) -> bool;
+
+  /** @brief Read a page from disk, recording the latency in stats_. Must not be called with the latch held. */
+  void ReadFromDisk(page_id_t page_id, char *page_data);
+
+  /** @brief Write a page to disk, recording the latency in stats_. Must not be called with the latch held. */
+  void WriteToDisk(page_id_t page_id, const char *page_data);
+
+  /** A page read or write handed to the disk scheduler by SubmitIo(). */
+  struct PendingIo {
+    std::future<bool> done_;
+    bool is_write_;
+    std::chrono::steady_clock::time_point submitted_;
+  };
+
+  /**
+   * @brief Hand many page reads or writes to the disk scheduler at once. Must not be called with the latch held.
+   * @param is_write true to write each page from its frame, false to read each page into its frame
+   * @param pages the page and the frame of each request
+   * @return the requests, in the same order, to be waited for with AwaitIo()
+   */
+  auto SubmitIo(bool is_write, const std::vector<std::pair<page_id_t, frame_id_t>> &pages) -> std::vector<PendingIo>;
+
+  /** @brief Wait for a request made by SubmitIo(), recording its latency in stats_. */
+  void AwaitIo(PendingIo *io);
+
+  /**
+   * @brief Mark the I/O on a reserved frame as finished and wake up its waiters. Caller should acquire the latch.
+   * @param frame_id the frame returned by ReserveFrame()
+   * @param dirty_page_id the evicted page returned by ReserveFrame()
+   */
+  void FinishIo(frame_id_t frame_id, page_id_t dirty_page_id);
+
+  /**
+   * @brief Wait until page_id is neither being loaded into a frame nor written back from one.
+   * @param lock the held latch, released while waiting
+   * @param page_id id of the page to look up
+   * @param[out] frame_id the frame holding page_id, if it is resident
+   * @return true if the page is resident in the buffer pool
+   */
+  auto WaitForPage(std::unique_lock<std::mutex> *lock, page_id_t page_id, frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Pin page_id without the latch, if it is resident, not loading, and already pinned by someone else.
+   * @param page_id id of the page to pin
+   * @param[out] frame_id the frame holding page_id
+   * @return true if the page was pinned; false means the caller must take the latch and try again
+   */
+  auto TryPinResident(page_id_t page_id, frame_id_t *frame_id) -> bool;
+
+  /** @brief Drop one pin on the frame, taking the latch only if it is the last one. */
+  void ReleasePin(frame_id_t frame_id);
+
+  /**
+   * @brief Pin a view of page_id for a read-only scan, taking a view from the disk manager if there is none yet. Caller
+   * should acquire the latch, and must have checked that the page is not resident.
+   * @return the page, or nullptr if the disk manager has no view of it
+   */
+  auto PinView(page_id_t page_id) -> Page *;
+
+  /**
+   * @brief Forget the view of page_id whose pins its frame adopted, now that the frame's last pin is gone. Caller should
+   * acquire the latch.
+   * @return true if there was one, which the caller must release from the disk manager once it drops the latch
+   */
+  auto DropAdoptedView(page_id_t page_id) -> bool;
+
+  /** @brief Main loop of the background writer thread. */
+  void BackgroundWriterLoop();
+
+  /** @brief Main loop of the prefetcher thread. */
+  void PrefetcherLoop();
 
-  // TODO(student): You may add additional private members and helper functions
+  /** @brief Let the prefetcher finish the reads it was given, then join it, if it is running. */
+  void StopPrefetcher();
 };
 }  // namespace bustub
@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <string>
+
+namespace bustub {
+
+/** The events a buffer pool counts, see BufferPoolStats. */
+enum class BufferPoolCounter {
+  /** Fetches that found the page in the pool. */
+  FETCH_HITS,
+  /** Fetches that had to read the page from disk. */
+  FETCH_MISSES,
+  /** Pages created by NewPage(). */
+  NEW_PAGES,
+  /** Frames reused whose old page was clean. */
+  CLEAN_EVICTIONS,
+  /** Frames reused whose old page had to be written back first. */
+  DIRTY_EVICTIONS,
+  /** Misses and new pages that failed because every frame was pinned. */
+  FAILED_EVICTIONS,
+  /** Times a thread waited for another thread's I/O on a page or frame before it could use it. */
+  PIN_WAITS,
+  /** Pages written by FlushPage() and FlushAllPages(). */
+  FLUSHES,
+  /** Pages written by the background writer. */
+  BACKGROUND_WRITES,
+  /** Pages read by the prefetcher. */
+  PREFETCHED_PAGES,
+  /** Fetches of read-only scans served in place by the disk manager, without a frame. */
+  PAGE_VIEWS,
+  NUM_COUNTERS
+};
+
+/** @return the name of the counter, e.g. "fetch_hits" */
+auto BufferPoolCounterToString(BufferPoolCounter counter) -> std::string;
+
+/**
+ * LatencyHistogram counts latencies in power-of-two buckets of microseconds: bucket 0 holds latencies below 1us, and
+ * bucket i > 0 holds latencies in [2^(i-1), 2^i) us. The last bucket also holds everything longer.
+ *
+ * Recording is lock-free, so it can be done from any thread. A copy is a snapshot of the buckets; it is not atomic as
+ * a whole, but every bucket is.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr size_t NUM_BUCKETS = 24;
+
+  LatencyHistogram() = default;
+  LatencyHistogram(const LatencyHistogram &other) { *this = other; }
+  auto operator=(const LatencyHistogram &other) -> LatencyHistogram &;
+
+  /** @brief Add the buckets of other to this histogram. */
+  auto operator+=(const LatencyHistogram &other) -> LatencyHistogram &;
+
+  /** @brief Count one latency. */
+  void Record(std::chrono::nanoseconds latency);
+
+  /** @return the number of latencies recorded */
+  auto GetCount() const -> uint64_t;
+
+  /** @return the number of latencies in bucket i */
+  auto GetBucket(size_t i) const -> uint64_t { return buckets_[i].load(std::memory_order_relaxed); }
+
+  /** @return the upper bound in microseconds of bucket i, i.e. 2^i */
+  static auto GetBucketBound(size_t i) -> uint64_t { return uint64_t{1} << i; }
+
+  /**
+   * @param percentile a number in [0, 100]
+   * @return an upper bound in microseconds of the given percentile of the recorded latencies, 0 if there are none
+   */
+  auto GetPercentile(double percentile) const -> uint64_t;
+
+ private:
+  std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets_{};
+};
+
+/**
+ * BufferPoolStats holds the counters and I/O latencies of a buffer pool. A buffer pool updates its own instance
+ * lock-free as it goes; BufferPoolManager::GetStats() hands out copies, which can be added up across shards.
+ */
+class BufferPoolStats {
+ public:
+  BufferPoolStats() = default;
+  BufferPoolStats(const BufferPoolStats &other) { *this = other; }
+  auto operator=(const BufferPoolStats &other) -> BufferPoolStats &;
+
+  /** @brief Add the counters and histograms of other to these stats. */
+  auto operator+=(const BufferPoolStats &other) -> BufferPoolStats &;
+
+  /** @brief Count n events of the given kind. */
+  void Add(BufferPoolCounter counter, uint64_t n = 1) {
+    counters_[static_cast<size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+  }
+
+  /** @return the number of events of the given kind */
+  auto Get(BufferPoolCounter counter) const -> uint64_t {
+    return counters_[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+  }
+
+  /** @return the latencies of page reads from disk */
+  auto GetReadLatency() -> LatencyHistogram & { return read_latency_; }
+  auto GetReadLatency() const -> const LatencyHistogram & { return read_latency_; }
+
+  /** @return the latencies of page writes to disk */
+  auto GetWriteLatency() -> LatencyHistogram & { return write_latency_; }
+  auto GetWriteLatency() const -> const LatencyHistogram & { return write_latency_; }
+
+ private:
+  std::array<std::atomic<uint64_t>, static_cast<size_t>(BufferPoolCounter::NUM_COUNTERS)> counters_{};
+  LatencyHistogram read_latency_;
+  LatencyHistogram write_latency_;
+};
+
+}  // namespace bustub
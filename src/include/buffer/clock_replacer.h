@@ -12,8 +12,8 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -23,6 +23,12 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * The replacer itself is lock-free: each frame's state (tracked, evictable, reference bit) is one atomic byte, and the
+ * clock hand is an atomic counter. RecordAccess() only sets the reference bit, and Evict() sweeps from the hand,
+ * clearing reference bits, and claims the first evictable frame without one with a CAS. BufferPoolManagerInstance
+ * still calls it under its own latch, so inside the buffer pool this only makes each call cheaper, not latch-free.
+ * Size() scans the state array, so it is O(n).
  */
 class ClockReplacer : public Replacer {
  public:
@@ -37,16 +43,27 @@ class ClockReplacer : public Replacer {
    */
   ~ClockReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
-  void Pin(frame_id_t frame_id) override;
+  void RecordAccess(frame_id_t frame_id) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
 
   auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me!
+  static constexpr uint8_t TRACKED = 1;
+  static constexpr uint8_t EVICTABLE = 2;
+  static constexpr uint8_t REFERENCED = 4;
+
+  size_t num_frames_;
+  std::atomic<uint8_t> *state_;
+  /** Position of the clock hand, taken modulo num_frames_. */
+  std::atomic<size_t> hand_{0};
 };
 
 }  // namespace bustub
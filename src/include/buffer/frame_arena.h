@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the page buffers of a buffer pool in one anonymous mapping, one BUSTUB_PAGE_SIZE slot per frame.
+ * Every slot is aligned to the OS page size, so frames can be read and written with O_DIRECT.
+ *
+ * The mapping only reserves address space. The OS backs a slot with memory once it is touched, and Release() gives
+ * that memory back, so a pool can keep slots for frames it may grow into without paying for them.
+ *
+ * With huge_pages set, the arena is aligned to 2 MB and asks for transparent huge pages, which saves TLB misses on
+ * large pools. It is only a hint; the kernel may ignore it.
+ */
+class FrameArena {
+ public:
+  /**
+   * @brief Map the memory of num_frames frames. Throws an OUT_OF_MEMORY Exception if that fails.
+   * @param num_frames the number of frames
+   * @param huge_pages whether to ask for transparent huge pages
+   */
+  FrameArena(size_t num_frames, bool huge_pages);
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  ~FrameArena();
+
+  /** @return the page buffer of frame_id; it reads as zeros until it is written */
+  auto GetFrame(frame_id_t frame_id) const -> char * {
+    return base_ + static_cast<size_t>(frame_id) * BUSTUB_PAGE_SIZE;
+  }
+
+  /** @brief Give the memory of frame_id back to the OS. Its buffer reads as zeros when it is used again. */
+  void Release(frame_id_t frame_id);
+
+  /** @return true if the kernel accepted the huge page hint */
+  auto UsesHugePages() const -> bool { return huge_pages_; }
+
+ private:
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /** The start of the mapping, and its length. */
+  char *mapping_;
+  size_t mapping_size_;
+  /** The first slot, aligned within the mapping. */
+  char *base_;
+  bool huge_pages_{false};
+};
+
+}  // namespace bustub
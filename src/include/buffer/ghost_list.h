@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// ghost_list.h
+//
+// Identification: src/include/buffer/ghost_list.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <iterator>
+#include <list>
+#include <unordered_map>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * GhostList remembers the ids of recently evicted pages, oldest first, up to a fixed capacity. Scan-resistant
+ * replacers (2Q, ARC) use it to tell a page that comes back soon after its eviction from one seen for the first time.
+ */
+class GhostList {
+ public:
+  explicit GhostList(size_t capacity) : capacity_(capacity) {}
+
+  /** @brief Remember page_id as the newest entry, forgetting the oldest entries beyond the capacity. */
+  void Push(page_id_t page_id) {
+    Erase(page_id);
+    if (capacity_ == 0) {
+      return;
+    }
+    pages_.push_back(page_id);
+    index_[page_id] = std::prev(pages_.end());
+    while (pages_.size() > capacity_) {
+      PopOldest();
+    }
+  }
+
+  /**
+   * @brief Forget page_id.
+   * @return true if the page was remembered
+   */
+  auto Erase(page_id_t page_id) -> bool {
+    auto it = index_.find(page_id);
+    if (it == index_.end()) {
+      return false;
+    }
+    pages_.erase(it->second);
+    index_.erase(it);
+    return true;
+  }
+
+  /** @brief Forget the oldest entry, if any. */
+  void PopOldest() {
+    if (pages_.empty()) {
+      return;
+    }
+    index_.erase(pages_.front());
+    pages_.pop_front();
+  }
+
+  /** @return true if page_id is remembered */
+  auto Contains(page_id_t page_id) const -> bool { return index_.count(page_id) != 0; }
+
+  /** @return the number of remembered pages */
+  auto Size() const -> size_t { return pages_.size(); }
+
+ private:
+  size_t capacity_;
+  std::list<page_id_t> pages_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> index_;
+};
+
+}  // namespace bustub
@@ -12,22 +12,17 @@
 
 #pragma once
 
-#include <chrono>  // NOLINT
-#include <ctime>
-#include <deque>
-#include <limits>
-#include <list>
+#include <cstdint>
 #include <mutex>  // NOLINT
-#include <unordered_map>
+#include <set>
 #include <utility>
 #include <vector>
 
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/logger.h"
 #include "common/macros.h"
 
-using TimePoint = std::chrono::time_point<std::chrono::high_resolution_clock>;
-
 namespace bustub {
 
 /**
@@ -40,8 +35,13 @@ namespace bustub {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * Timestamps are logical: every RecordAccess() advances a counter. Each frame keeps its last k timestamps in a
+ * fixed-size ring buffer. Frames with +inf backward k-distance sit in an intrusive FIFO ordered by first access;
+ * evictable frames with a finite distance sit in an ordered set keyed by their k-th most recent access. Every
+ * operation is O(log n), except that Evict() skips over non-evictable frames at the head of the FIFO.
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
   /**
    *
@@ -59,7 +59,7 @@ class LRUKReplacer {
    *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer();
+  ~LRUKReplacer() override;
 
   /**
    * TODO(P1): Add implementation
@@ -77,7 +77,7 @@ class LRUKReplacer {
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
   /**
    * TODO(P1): Add implementation
@@ -90,7 +90,7 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame that received a new access.
    */
-  void RecordAccess(frame_id_t frame_id);
+  void RecordAccess(frame_id_t frame_id) override;
 
   /**
    * TODO(P1): Add implementation
@@ -109,7 +109,7 @@ class LRUKReplacer {
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
    * TODO(P1): Add implementation
@@ -128,7 +128,16 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
+
+  /**
+   * @brief Return up to max_count evictable frames in the order Evict() would pick them, without evicting them or
+   * touching their access history. Used by the background writer to clean frames ahead of eviction.
+   *
+   * @param max_count maximum number of frames to return
+   * @return evictable frames, next victim first
+   */
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
 
   /**
    * TODO(P1): Add implementation
@@ -137,14 +146,41 @@ class LRUKReplacer {
    *
    * @return size_t
    */
-  auto Size() -> size_t;
+  auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  std::pair<frame_id_t, std::deque<TimePoint>> *record_pair_;
-  bool *evictable_tag_;
-  [[maybe_unused]] size_t current_timestamp_{0};
+  static constexpr frame_id_t INVALID_FRAME_ID = -1;
+
+  /** Per-frame replacer state. A frame is tracked iff count_ > 0. */
+  struct FrameInfo {
+    /** Number of valid timestamps in the frame's history ring, at most k. */
+    size_t count_{0};
+    /** Ring slot of the oldest timestamp, i.e. the k-th most recent access once count_ == k. */
+    size_t head_{0};
+    bool evictable_{false};
+    /** Links of the +inf FIFO; only meaningful while 0 < count_ < k. */
+    frame_id_t prev_{INVALID_FRAME_ID};
+    frame_id_t next_{INVALID_FRAME_ID};
+  };
+
+  /** @return the oldest timestamp kept for the frame */
+  auto OldestAccess(frame_id_t frame_id) const -> uint64_t { return history_[frame_id * k_ + frames_[frame_id].head_]; }
+
+  void PushHistory(frame_id_t frame_id);
+  void LinkInf(frame_id_t frame_id);
+  void UnlinkInf(frame_id_t frame_id);
+  /** Drop all state of a tracked, evictable frame. */
+  void Forget(frame_id_t frame_id);
+
+  FrameInfo *frames_;
+  /** replacer_size_ rings of k_ timestamps each. */
+  uint64_t *history_;
+  /** Head (oldest first access) and tail of the +inf FIFO. */
+  frame_id_t inf_head_{INVALID_FRAME_ID};
+  frame_id_t inf_tail_{INVALID_FRAME_ID};
+  /** Evictable frames with k accesses, keyed by their k-th most recent access. */
+  std::set<std::pair<uint64_t, frame_id_t>> finite_;
+  uint64_t current_timestamp_{0};
   size_t curr_size_{0};
   size_t replacer_size_;
   size_t k_;
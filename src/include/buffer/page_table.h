@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the ids of resident pages to the frames holding them.
+ *
+ * It is a fixed-capacity open-addressing hash table with linear probing. Each slot is one atomic 64-bit word holding
+ * both the page id and the frame id, so a lookup never sees a half-written entry and needs no latch. The capacity is
+ * at least twice the number of frames, which bounds the load factor at 1/2.
+ *
+ * Insert() and Remove() must be serialized by the caller (the buffer pool holds its latch for them). Remove() uses
+ * backward-shift deletion, so there are no tombstones, but a Find() racing with it may miss an entry that is being
+ * shifted. Find() therefore only gives a definite answer when no Remove() runs concurrently; a lock-free caller must
+ * treat a miss as "take the latch and look again", and a hit as a hint to be validated against the frame.
+ */
+class PageTable {
+ public:
+  /**
+   * @brief Create a new PageTable.
+   * @param num_frames the maximum number of entries the table will hold
+   */
+  explicit PageTable(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  ~PageTable();
+
+  /**
+   * @brief Look up the frame holding page_id. Lock-free.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame holding the page, if found
+   * @return true if the page was found
+   */
+  auto Find(page_id_t page_id, frame_id_t *frame_id) const -> bool;
+
+  /**
+   * @brief Insert a mapping for a page that is not in the table yet. Callers must serialize Insert() and Remove().
+   * @param page_id the page
+   * @param frame_id the frame holding it
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * @brief Remove the mapping of page_id. Callers must serialize Insert() and Remove().
+   * @param page_id the page
+   * @return true if the page was in the table
+   */
+  auto Remove(page_id_t page_id) -> bool;
+
+ private:
+  static constexpr uint64_t EMPTY = UINT64_MAX;
+
+  static auto Pack(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto PageOf(uint64_t slot) -> page_id_t { return static_cast<page_id_t>(slot >> 32); }
+  static auto FrameOf(uint64_t slot) -> frame_id_t { return static_cast<frame_id_t>(slot & UINT32_MAX); }
+
+  /** @return the slot page_id would occupy in an empty table */
+  auto Home(page_id_t page_id) const -> size_t;
+  /** @return the slot holding page_id, or capacity_ if there is none. Only exact when writers are excluded. */
+  auto Locate(page_id_t page_id) const -> size_t;
+
+  /** Number of slots, a power of two. */
+  size_t capacity_;
+  /** 64 - log2(capacity_), for Fibonacci hashing. */
+  int shift_;
+  std::atomic<uint64_t> *slots_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager spreads pages over several independent BufferPoolManagerInstances (shards).
+ *
+ * Page page_id always lives in shard (page_id % num_instances). Every shard owns its own latch, page table, replacer
+ * and free list, so threads touching pages of different shards never contend with each other. New pages are handed
+ * out round-robin across the shards.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * @brief Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to create
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer of each shard
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_policy the replacement policy of each shard
+   * @param max_pool_size the size ResizePool() may grow each shard to; smaller values mean pool_size
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                            ReplacerPolicy replacer_policy = ReplacerPolicy::LRU_K, size_t max_pool_size = 0);
+
+  /**
+   * @brief Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @brief Return the total size (number of frames) of all the shards. */
+  auto GetPoolSize() -> size_t override;
+
+  /**
+   * @brief Resize every shard so that together they hold pool_size frames, spread as evenly as possible.
+   * @param pool_size the new total number of frames; each shard must fit its share (see
+   * BufferPoolManagerInstance::ResizePool())
+   * @return false if some shard could only shrink part of the way
+   */
+  auto ResizePool(size_t pool_size) -> bool override;
+
+  /** @brief Return the counters and I/O latencies of all the shards added up. */
+  auto GetStats() -> BufferPoolStats override;
+
+  /** @brief Return the number of shards. */
+  auto GetNumInstances() const -> size_t { return instances_.size(); }
+
+  /**
+   * @param page_id id of page
+   * @return pointer to the BufferPoolManagerInstance responsible for handling the given page id
+   */
+  auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance *;
+
+ protected:
+  /**
+   * @brief Fetch the requested page from the shard responsible for it.
+   * @param page_id id of page to be fetched
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id) -> Page * override;
+
+  /**
+   * @brief Fetch the requested page from the shard responsible for it, reusing the strategy's ring frames in that
+   * shard.
+   * @param page_id id of page to be fetched
+   * @param strategy the scan's strategy, may be nullptr
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * @brief Prefetch the given pages, each in the shard responsible for it.
+   * @param first_page_id id of the first page to prefetch
+   * @param count number of consecutive page ids to prefetch
+   * @param strategy the scan's strategy, may be nullptr
+   */
+  void PrefetchPgsImp(page_id_t first_page_id, size_t count, BufferAccessStrategy *strategy) override;
+
+  /**
+   * @brief Unpin the target page in the shard responsible for it.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
+
+  /**
+   * @brief Flush the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  auto FlushPgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * @brief Create a new page. Shards are tried round-robin, starting one past the shard used by the previous call,
+   * until one of them has a frame available. Every shard is tried at most once.
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id) -> Page * override;
+
+  /**
+   * @brief Delete a page from the shard responsible for it.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  auto DeletePgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * @brief Flush all the pages of every shard to disk.
+   */
+  void FlushAllPgsImp() override;
+
+ private:
+  /** The shards, indexed by (page_id % num_instances). */
+  std::vector<BufferPoolManagerInstance *> instances_;
+  /** The shard NewPgImp() starts from next time. */
+  std::atomic<size_t> next_instance_{0};
+};
+
+}  // namespace bustub
@@ -12,12 +12,21 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** The replacement policies a buffer pool can be built with. */
+enum class ReplacerPolicy { LRU_K, LRU, CLOCK, TWO_QUEUE, ARC };
+
 /**
- * Replacer is an abstract class that tracks page usage.
+ * Replacer is an abstract class that tracks frame usage and picks the frame to evict.
+ *
+ * The buffer pool reports every access to a frame with RecordAccess(), and marks a frame evictable when its pin count
+ * drops to zero. Frames are only ever evicted while evictable.
  */
 class Replacer {
  public:
@@ -25,26 +34,72 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
-   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
+   * @brief Evict the victim frame as defined by the replacement policy, dropping the frame's access history. Only
+   * evictable frames are candidates.
+   * @param[out] frame_id id of frame that was evicted
    * @return true if a victim frame was found, false otherwise
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
+
+  /**
+   * @brief Record an access to the frame. Starts tracking the frame if it is not tracked yet.
+   * @param frame_id id of frame that received a new access
+   */
+  virtual void RecordAccess(frame_id_t frame_id) = 0;
+
+  /**
+   * @brief Tell the replacer that the frame was just loaded with page_id, before the first RecordAccess() of the page.
+   * Policies that remember recently evicted pages (2Q, ARC) use it to recognise a re-reference; the default ignores
+   * it.
+   * @param frame_id id of the frame
+   * @param page_id id of the page now held by the frame
+   */
+  virtual void RecordLoad(frame_id_t frame_id, page_id_t page_id) {}
+
+  /**
+   * @brief Toggle whether a tracked frame is evictable. Does nothing for frames that are not tracked.
+   * @param frame_id id of frame whose 'evictable' status will be modified
+   * @param set_evictable whether the given frame is evictable or not
+   */
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
 
   /**
-   * Pins a frame, indicating that it should not be victimized until it is unpinned.
-   * @param frame_id the id of the frame to pin
+   * @brief Stop tracking an evictable frame regardless of its position in the eviction order, e.g. because its page
+   * was deleted. Does nothing for frames that are not tracked; aborts for non-evictable frames.
+   * @param frame_id id of frame to be removed
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual void Remove(frame_id_t frame_id) = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
-   * @param frame_id the id of the frame to unpin
+   * @brief Return up to max_count evictable frames, next victim first, without evicting them or touching their
+   * access history. Policies may only approximate the order in which Evict() will actually pick them.
+   * @param max_count maximum number of frames to return
+   * @return evictable frames, next victim first
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
+  virtual auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> = 0;
 
-  /** @return the number of elements in the replacer that can be victimized */
+  /** @return the number of evictable frames */
   virtual auto Size() -> size_t = 0;
 };
 
+/**
+ * @brief Create a replacer.
+ * @param policy the replacement policy
+ * @param num_frames the maximum number of frames the replacer will be required to track
+ * @param k the lookback constant, only used by ReplacerPolicy::LRU_K
+ * @return the new replacer, owned by the caller
+ */
+auto MakeReplacer(ReplacerPolicy policy, size_t num_frames, size_t k) -> Replacer *;
+
+/**
+ * @brief Parse a policy name: "lru_k", "lru", "clock", "2q" or "arc".
+ * @param name the name to parse
+ * @param[out] policy the parsed policy
+ * @return false if the name is unknown
+ */
+auto ParseReplacerPolicy(const std::string &name, ReplacerPolicy *policy) -> bool;
+
+/** @return the name of the policy, as accepted by ParseReplacerPolicy() */
+auto ReplacerPolicyToString(ReplacerPolicy policy) -> std::string;
+
 }  // namespace bustub
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.h
+//
+// Identification: src/include/buffer/two_queue_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/ghost_list.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQueueReplacer implements the 2Q replacement policy (Johnson and Shasha, VLDB '94).
+ *
+ * A newly loaded page enters A1in, a FIFO that absorbs one-off accesses such as sequential scans. When a page falls
+ * out of A1in, its id is remembered in the ghost list A1out. If the page is loaded again while still in A1out, it has
+ * proven to be reused and enters Am, an LRU list of hot pages. Victims come from A1in while it holds more than a
+ * quarter of the frames, and from Am otherwise, so a long scan can never flush the hot set.
+ *
+ * Pages only reach Am through A1out, so the replacer needs RecordLoad() to know which page each frame holds.
+ */
+class TwoQueueReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new TwoQueueReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to track
+   */
+  explicit TwoQueueReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(TwoQueueReplacer);
+
+  ~TwoQueueReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void RecordLoad(frame_id_t frame_id, page_id_t page_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
+
+  auto Size() -> size_t override;
+
+ private:
+  enum class Queue { NONE, A1IN, AM };
+
+  struct FrameInfo {
+    Queue queue_{Queue::NONE};
+    std::list<frame_id_t>::iterator pos_;
+    bool evictable_{false};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    /** The page was found in A1out when loaded, so it goes straight to Am. */
+    bool hot_{false};
+  };
+
+  /** @return the queue Evict() takes its victim from */
+  auto PreferA1in() const -> bool { return a1in_.size() > kin_; }
+  auto ListOf(Queue queue) -> std::list<frame_id_t> & { return queue == Queue::A1IN ? a1in_ : am_; }
+  /** Drop all state of a tracked frame. */
+  void Forget(frame_id_t frame_id);
+
+  size_t num_frames_;
+  /** Target size of A1in. */
+  size_t kin_;
+  std::vector<FrameInfo> frames_;
+  /** Oldest first. */
+  std::list<frame_id_t> a1in_;
+  /** Least recently used first. */
+  std::list<frame_id_t> am_;
+  GhostList a1out_;
+  size_t curr_size_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -22,6 +22,7 @@
 #include <utility>
 #include <vector>
 
+#include "buffer/replacer.h"
 #include "catalog/catalog.h"
 #include "common/config.h"
 #include "common/util/string_util.h"
@@ -211,9 +212,20 @@ class BustubInstance {
   auto MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext>;
 
  public:
-  explicit BustubInstance(const std::string &db_file_name);
+  /**
+   * Create a BusTub instance on a database file.
+   * @param pool_size the number of buffer pool frames
+   * @param max_pool_size the number of frames the buffer pool may be grown to at runtime; smaller values mean pool_size
+   * @param direct_io bypass the OS page cache for the database file, see DiskManager
+   * @param mmap_reads map the database file, so that read-only queries scan the pages that are not in the buffer pool
+   * in place, see DiskManagerMmap; direct_io is ignored then
+   */
+  explicit BustubInstance(const std::string &db_file_name, ReplacerPolicy replacer_policy = ReplacerPolicy::LRU_K,
+                          size_t pool_size = BUSTUB_INSTANCE_POOL_SIZE, size_t max_pool_size = 0,
+                          bool direct_io = false, bool mmap_reads = false);
 
-  BustubInstance();
+  /** Create an in-memory BusTub instance, with a buffer pool sized like above. */
+  explicit BustubInstance(size_t pool_size = BUSTUB_INSTANCE_POOL_SIZE, size_t max_pool_size = 0);
 
   ~BustubInstance();
 
@@ -270,6 +282,9 @@ class BustubInstance {
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
+  void CmdDisplayBufferPoolStats(ResultWriter &writer);
+  void CmdResizeBufferPool(const std::string &arg, ResultWriter &writer);
+  void CmdCompactDatabase(ResultWriter &writer);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
   std::unordered_map<std::string, std::string> session_variables_;
 };
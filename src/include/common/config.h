@@ -27,15 +27,28 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** A running buffer pool background writer checks for dirty frames to clean every BACKGROUND_WRITER_INTERVAL. */
+extern std::chrono::milliseconds background_writer_interval;
+
+/** If ENABLE_HUGE_PAGES is true, buffer pools created from then on ask for transparent huge pages for their frames. */
+extern bool enable_huge_pages;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
 static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int DIRECT_IO_ALIGNMENT = 4096;                                     // alignment of O_DIRECT buffers
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
+static constexpr int BUSTUB_INSTANCE_POOL_SIZE = 128;                                // pool size of a BustubInstance
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
-static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int LRUK_REPLACER_K = 10;             // lookback window for lru-k replacer
+static constexpr int SCAN_RING_SIZE = 16;              // frames a ring-buffered sequential scan cycles through
+static constexpr int SCAN_PREFETCH_WINDOW = 4;         // pages a sequential scan reads ahead of itself
+static constexpr int DISK_SCHEDULER_WORKERS = 2;       // I/O threads of a disk scheduler
+static constexpr int DISK_SCHEDULER_BATCH_SIZE = 32;   // requests a disk scheduler worker takes at once
+static constexpr int DISK_SCHEDULER_EXTENT_SIZE = 16;  // adjacent pages that share a disk scheduler worker
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -192,6 +192,12 @@ class Transaction {
   /** @return the isolation level of this transaction */
   inline auto GetIsolationLevel() const -> IsolationLevel { return isolation_level_; }
 
+  /** @return true if the transaction only reads, so its scans may read pages in place instead of through frames */
+  inline auto IsReadOnly() const -> bool { return read_only_; }
+
+  /** @brief Declare whether the transaction only reads. */
+  inline void SetReadOnly(bool read_only) { read_only_ = read_only; }
+
   /** @return the list of table write records of this transaction */
   inline auto GetWriteSet() -> std::shared_ptr<std::deque<TableWriteRecord>> { return table_write_set_; }
 
@@ -328,6 +334,8 @@ class Transaction {
   TransactionState state_{TransactionState::GROWING};
   /** The isolation level of the transaction. */
   IsolationLevel isolation_level_;
+  /** True if the transaction only reads. */
+  bool read_only_{false};
   /** The thread ID, used in single-threaded transactions. */
   std::thread::id thread_id_;
   /** The ID of this transaction. */
@@ -13,10 +13,13 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
+#include <shared_mutex>
 #include <string>
+#include <vector>
 
 #include "common/config.h"
 
@@ -25,19 +28,30 @@ namespace bustub {
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Page I/O uses positional reads and writes on the database file, so ReadPage() and WritePage() may be called from
+ * many threads at once. A written page reaches the OS page cache only; call SyncPages() to make it durable.
+ *
+ * The disk manager also keeps the free-page map of the database: pages given back with DeallocatePage() are handed
+ * out again by AllocateFreePage() before the file grows. The map is a bitmap, persisted next to the database file in
+ * a ".fsm" file by SyncPages(), and Compact() truncates the free pages at the end of the file.
+ *
+ * With direct I/O, pages bypass the OS page cache, so the buffer pool is the only cache of the database. O_DIRECT needs
+ * buffers aligned to DIRECT_IO_ALIGNMENT, as the frames of a buffer pool are; other buffers go through an aligned copy.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io open the database file with O_DIRECT, bypassing the OS page cache, if the file system allows it
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = false);
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
   DiskManager() = default;
 
-  virtual ~DiskManager() = default;
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -58,6 +72,73 @@ class DiskManager {
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Write adjacent pages to the database file, with a single vectored write if possible.
+   * @param first_page_id id of the first page
+   * @param pages_data raw data of each page, one buffer per page
+   * @param count number of pages, at most IOV_MAX
+   * @return false if there was an I/O error
+   */
+  virtual auto WritePages(page_id_t first_page_id, const char *const *pages_data, size_t count) -> bool;
+
+  /**
+   * Read adjacent pages from the database file, with a single vectored read if possible.
+   * @param first_page_id id of the first page
+   * @param[out] pages_data output buffer of each page
+   * @param count number of pages, at most IOV_MAX
+   * @return false if there was an I/O error
+   */
+  virtual auto ReadPages(page_id_t first_page_id, char *const *pages_data, size_t count) -> bool;
+
+  /**
+   * Force all pages written so far, and the free-page map, to stable storage.
+   */
+  virtual void SyncPages();
+
+  /**
+   * Give a page back. Its contents are lost, and AllocateFreePage() may hand it out again.
+   * @param page_id id of the page, which nobody may use any more
+   */
+  void DeallocatePage(page_id_t page_id);
+
+  /**
+   * Take the lowest free page whose id is residue modulo stride, so that a buffer pool shard only gets its own ids.
+   * @param stride the number of buffer pool shards
+   * @param residue the index of the shard
+   * @return the id of the page, which is no longer free, or INVALID_PAGE_ID if there is none
+   */
+  auto AllocateFreePage(uint32_t stride = 1, uint32_t residue = 0) -> page_id_t;
+
+  /** @return true if page_id was given back with DeallocatePage() and not allocated since */
+  auto IsPageFree(page_id_t page_id) -> bool;
+
+  /** @return the number of free pages */
+  auto GetNumFreePages() -> size_t;
+
+  /** @return the number of pages in the database file; no page at or beyond it has ever been written */
+  auto GetNumPages() -> page_id_t;
+
+  /**
+   * Truncate the run of free pages at the end of the database file. The pages stay free. Free pages in the middle of
+   * the file stay where they are, since the pages that point to a live page cannot be rewritten from here.
+   * @return the number of pages the file shrank by
+   */
+  virtual auto Compact() -> size_t;
+
+  /** @return true if AcquirePageView() can hand out pages in place, see DiskManagerMmap */
+  virtual auto SupportsPageViews() const -> bool { return false; }
+
+  /**
+   * Get a read-only view of a page in place, without copying it. The view stays valid, and the page unchanged, until
+   * it is released with ReleasePageView().
+   * @param page_id id of the page
+   * @return the page data, or nullptr if no view of the page can be taken right now
+   */
+  virtual auto AcquirePageView(page_id_t page_id) -> const char * { return nullptr; }
+
+  /** @brief Release a view taken with AcquirePageView(). */
+  virtual void ReleasePageView(page_id_t page_id) {}
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -83,6 +164,9 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /** @return true if the database file is open with O_DIRECT */
+  auto IsDirectIo() const -> bool { return direct_io_; }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -93,19 +177,43 @@ class DiskManager {
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
  protected:
+  /** @return true if data can be read or written without an aligned copy */
+  auto IsAligned(const char *data) const -> bool {
+    return !direct_io_ || reinterpret_cast<uintptr_t>(data) % DIRECT_IO_ALIGNMENT == 0;
+  }
+
+  /** The io_uring backend of the scheduler submits I/O on db_fd_ itself. */
+  friend class DiskScheduler;
+
   auto GetFileSize(const std::string &file_name) -> int;
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // file descriptor of the db file, -1 when closed
+  int db_fd_{-1};
+  bool direct_io_{false};
   std::string file_name_;
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
+  /** Page writes hold this shared and Compact() exclusive, so that no write lands beyond the end of the file as it is
+   * cut. */
+  std::shared_mutex truncate_latch_;
+
+ private:
+  /** @brief Read the free-page map from fsm_name_, dropping the pages beyond the end of the database file. */
+  void LoadFreePageMap();
+  /** @brief Write the free-page map to fsm_name_ if it changed. Caller should acquire free_map_latch_. */
+  void SaveFreePageMap();
+
+  /** One bit per page, set if the page is free. Protected by free_map_latch_. */
+  std::vector<uint64_t> free_map_;
+  size_t num_free_pages_{0};
+  /** True if free_map_ changed since it was last saved. */
+  bool free_map_dirty_{false};
+  std::string fsm_name_;
+  std::mutex free_map_latch_;
 };
 
 }  // namespace bustub
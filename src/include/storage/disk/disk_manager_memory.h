@@ -9,7 +9,11 @@
 // Copyright (c) 2015-2020, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+
+#pragma once
+
 #include <array>
+#include <atomic>
 #include <cstring>
 #include <fstream>
 #include <future>  // NOLINT
@@ -24,19 +28,30 @@
 #include "common/config.h"
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 /**
  * DiskManagerMemory replicates the utility of DiskManager on memory. It is primarily used for
- * data structure performance testing.
+ * data structure performance testing, and for in-memory benchmarks and caches.
+ *
+ * Pages live in segments of PAGES_PER_SEGMENT pages, mapped the first time one of their pages is written, so memory
+ * grows with the pages in use and no page ever moves. Reads and writes may run concurrently: a lock stripe serializes
+ * the accesses to each page, and pages that were never written read as zeros.
  */
 class DiskManagerMemory : public DiskManager {
  public:
-  explicit DiskManagerMemory(size_t pages);
+  /**
+   * @brief Create a new in-memory disk manager.
+   * @param pages the number of pages to map up front; more are mapped as they are written
+   */
+  explicit DiskManagerMemory(size_t pages = 0);
 
-  ~DiskManagerMemory() override { delete[] memory_; }
+  DISALLOW_COPY_AND_MOVE(DiskManagerMemory);
+
+  ~DiskManagerMemory() override;
 
   /**
    * Write a page to the database file.
@@ -52,8 +67,24 @@ class DiskManagerMemory : public DiskManager {
    */
   void ReadPage(page_id_t page_id, char *page_data) override;
 
+  /** @return the number of segments mapped so far */
+  auto GetNumSegments() const -> size_t { return num_segments_.load(); }
+
+  static constexpr size_t PAGES_PER_SEGMENT = 1024;
+  /** The most segments a disk manager can map, i.e. 256 GB of pages. */
+  static constexpr size_t MAX_SEGMENTS = 1 << 16;
+
  private:
-  char *memory_;
+  static constexpr size_t NUM_STRIPES = 64;
+
+  /** @return the segment holding page_id, mapping it if create is set; nullptr if it is not mapped */
+  auto GetSegment(page_id_t page_id, bool create) -> char *;
+
+  /** The segment directory, filled lazily and never shrunk, so lookups need no latch. */
+  std::unique_ptr<std::atomic<char *>[]> segments_;
+  std::atomic<size_t> num_segments_{0};
+  /** Page page_id is protected by stripes_[page_id % NUM_STRIPES]. */
+  std::array<std::shared_mutex, NUM_STRIPES> stripes_;
 };
 
 /**
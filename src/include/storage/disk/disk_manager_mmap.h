@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.h
+//
+// Identification: src/include/storage/disk/disk_manager_mmap.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerMmap is a DiskManager that also maps the database file read-only, so that a read-only scan can read the
+ * pages that are not in the buffer pool in place, straight from the OS page cache, without copying them into a frame.
+ * Writes still come from the buffer pool through WritePage().
+ *
+ * A page handed out by AcquirePageView() must not change under its readers, so a write of a page that has views is
+ * deferred until its last view is released. ReadPage() returns the deferred data meanwhile, but SyncPages() does not
+ * make it durable until then; this mode is meant for read-mostly databases, where that is rare.
+ *
+ * The file is mapped in chunks of MMAP_CHUNK_PAGES pages as the views reach them; a chunk stays mapped as the file
+ * grows, so a view never moves.
+ */
+class DiskManagerMmap : public DiskManager {
+ public:
+  /**
+   * Creates a new disk manager that writes to, and maps, the specified database file.
+   * @param db_file the file name of the database file
+   */
+  explicit DiskManagerMmap(const std::string &db_file);
+
+  DISALLOW_COPY_AND_MOVE(DiskManagerMmap);
+
+  ~DiskManagerMmap() override;
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /** Writes and reads page by page, since each page may have views. */
+  auto WritePages(page_id_t first_page_id, const char *const *pages_data, size_t count) -> bool override;
+  auto ReadPages(page_id_t first_page_id, char *const *pages_data, size_t count) -> bool override;
+
+  auto SupportsPageViews() const -> bool override { return true; }
+
+  auto AcquirePageView(page_id_t page_id) -> const char * override;
+
+  void ReleasePageView(page_id_t page_id) override;
+
+  /** Does nothing while any page has views, since cutting the file would pull pages from under the mapping. */
+  auto Compact() -> size_t override;
+
+  /** @return the number of pages that have views */
+  auto GetNumViewedPages() -> size_t;
+
+  static constexpr size_t MMAP_CHUNK_PAGES = 16384;
+
+ private:
+  /** A page that is being written has this view count: no view may be taken, and no other write may start. */
+  static constexpr int WRITING = -1;
+
+  /** @brief Write page_id to the file, with no views of it allowed meanwhile. Caller should hold view_latch_. */
+  void WriteUnviewed(std::unique_lock<std::mutex> *lock, page_id_t page_id, const char *page_data);
+  /** @brief Wait until no write of page_id is landing. Caller should hold view_latch_. */
+  void WaitForWrite(std::unique_lock<std::mutex> *lock, page_id_t page_id);
+
+  std::mutex view_latch_;
+  std::condition_variable write_cv_;
+  /** The number of views of each page that has any, or WRITING. */
+  std::unordered_map<page_id_t, int> view_counts_;
+  /** The latest write of each page that had views at the time. */
+  std::unordered_map<page_id_t, std::unique_ptr<char[]>> deferred_writes_;
+  /** The mapped chunks of the file, nullptr where none was needed yet. */
+  std::vector<char *> chunks_;
+  /** The pages known to be in the file; views are only handed out below it, since the mapping faults beyond. */
+  page_id_t num_file_pages_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** A page read or write handed to the DiskScheduler. */
+struct DiskRequest {
+  /** True for a write, false for a read. */
+  bool is_write_;
+  /** The page buffer to write from or read into; it must stay valid until the request is done. */
+  char *data_;
+  /** The page to write or read. */
+  page_id_t page_id_;
+  /** Set to true when the request is done, or to false if it failed. */
+  std::promise<bool> callback_;
+};
+
+/** How the DiskScheduler issues its I/O. */
+enum class DiskSchedulerBackend {
+  /** io_uring if the kernel supports it, the thread pool otherwise. */
+  AUTO,
+  /** The worker threads call the DiskManager themselves, one run of adjacent pages at a time. */
+  THREAD_POOL,
+  /** The worker threads submit all runs of a batch to an io_uring at once, and wait for them together. */
+  IO_URING
+};
+
+class IoUring;
+
+/**
+ * DiskScheduler runs page reads and writes on behalf of other threads, so that they can submit I/O without waiting for
+ * it and only block on the promise of the request once they need the result.
+ *
+ * Requests go to one of a few worker threads by page id: adjacent pages (DISK_SCHEDULER_EXTENT_SIZE of them) share a
+ * worker, and requests for the same page always run in the order they were scheduled. A worker takes up to
+ * DISK_SCHEDULER_BATCH_SIZE queued requests at once, sorts them by page id and merges runs of adjacent pages in the same
+ * direction into a single preadv/pwritev, or a single io_uring operation.
+ *
+ * The io_uring backend works on the file of a DiskManager directly. It is only picked for a DiskManager with an open
+ * file and no page views; subclasses that keep their pages elsewhere, or override ReadPage()/WritePage(), should use
+ * THREAD_POOL.
+ *
+ * The worker threads are started by the first request.
+ */
+class DiskScheduler {
+ public:
+  /**
+   * @brief Create a new DiskScheduler.
+   * @param disk_manager the disk manager that owns the database file
+   * @param num_workers the number of worker threads
+   * @param backend how to issue I/O; falls back to THREAD_POOL if io_uring is not available
+   */
+  explicit DiskScheduler(DiskManager *disk_manager, size_t num_workers = DISK_SCHEDULER_WORKERS,
+                         DiskSchedulerBackend backend = DiskSchedulerBackend::AUTO);
+
+  DISALLOW_COPY_AND_MOVE(DiskScheduler);
+
+  /** @brief Finish all scheduled requests and stop the worker threads. */
+  ~DiskScheduler();
+
+  /**
+   * @brief Schedule a request. Returns right away; the request's promise is set once it is done.
+   * @param request the request
+   */
+  void Schedule(DiskRequest request);
+
+  /**
+   * @brief Schedule many requests at once, so that a worker can merge the adjacent ones. Takes the requests out of
+   * the vector.
+   * @param requests the requests
+   */
+  void Schedule(std::vector<DiskRequest> *requests);
+
+  /** @return a promise for a new request */
+  static auto CreatePromise() -> std::promise<bool> { return {}; }
+
+  /** @return the backend in use, THREAD_POOL or IO_URING */
+  auto GetBackend() const -> DiskSchedulerBackend { return backend_; }
+
+ private:
+  struct Worker {
+    std::mutex latch_;
+    std::condition_variable cv_;
+    /** Requests waiting for this worker, protected by latch_. */
+    std::deque<DiskRequest> queue_;
+    /** Set under latch_ to ask the worker to exit once its queue is empty. */
+    bool stop_{false};
+    std::thread thread_;
+    /** The ring of the io_uring backend, nullptr for the thread pool backend. */
+    std::unique_ptr<IoUring> ring_;
+  };
+
+  /** @brief Start the worker threads, unless they are running already. */
+  void StartWorkers();
+
+  /** @return the index of the worker that runs requests for page_id */
+  auto WorkerOf(page_id_t page_id) const -> size_t;
+
+  void WorkerLoop(Worker *worker);
+
+  /** @brief Run a batch of requests for distinct pages, sorted by page id, and set their promises. */
+  void RunBatch(Worker *worker, std::vector<DiskRequest> *batch);
+
+  /** @brief Run requests [begin, end) of a batch, a run of adjacent pages, through the DiskManager. */
+  auto RunSync(std::vector<DiskRequest> *batch, size_t begin, size_t end) -> bool;
+
+  DiskManager *disk_manager_;
+  DiskSchedulerBackend backend_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::once_flag start_workers_;
+};
+
+}  // namespace bustub
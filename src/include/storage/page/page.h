@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -30,10 +31,10 @@ class Page {
   friend class BufferPoolManagerInstance;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. The page has no data until the buffer pool gives it a frame buffer. */
+  Page() = default;
 
-  /** Default destructor. */
+  /** Default destructor. The buffer pool owns the data. */
   ~Page() = default;
 
   /** @return the actual data contained within this page */
@@ -78,14 +79,18 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, BUSTUB_PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[BUSTUB_PAGE_SIZE]{};
-  /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
+  /**
+   * The actual data that is stored within a page, BUSTUB_PAGE_SIZE bytes of the buffer pool's FrameArena. Kept apart
+   * from the book-keeping below so that the buffer pool can release the memory of a frame it stops using while
+   * lock-free lookups may still read the frame's page id and pin count.
+   */
+  char *data_{nullptr};
+  /** The ID of this page. Atomic because the buffer pool reads it without its latch on the hit path. */
+  std::atomic<page_id_t> page_id_ = INVALID_PAGE_ID;
   /** The pin count of this page. */
-  int pin_count_ = 0;
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
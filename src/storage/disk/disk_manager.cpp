@@ -10,33 +10,79 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
-#include <mutex>  // NOLINT
+#include <shared_mutex>
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+/** A page buffer aligned for direct I/O, for callers whose own buffer is not. */
+struct AlignedPage {
+  alignas(DIRECT_IO_ALIGNMENT) char data_[BUSTUB_PAGE_SIZE];
+};
+
+/**
+ * Run preadv/pwritev until all of iov is transferred, resuming after short transfers. Consumes iov.
+ * @return the number of bytes transferred, which is short if a read hits the end of the file, or -1 on an I/O error
+ */
+static auto TransferPages(bool is_write, int fd, struct iovec *iov, int iovcnt, off_t offset) -> ssize_t {
+  ssize_t total = 0;
+  while (iovcnt > 0) {
+    ssize_t ret = is_write ? pwritev(fd, iov, iovcnt, offset + total) : preadv(fd, iov, iovcnt, offset + total);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret < 0) {
+      return -1;
+    }
+    if (ret == 0) {
+      break;
+    }
+    total += ret;
+    // skip the buffers that are done, and trim the one that is done in part
+    while (iovcnt > 0 && static_cast<size_t>(ret) >= iov->iov_len) {
+      ret -= iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = static_cast<char *>(iov->iov_base) + ret;
+      iov->iov_len -= ret;
+    }
+  }
+  return total;
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io) : file_name_(db_file) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  fsm_name_ = file_name_.substr(0, n) + ".fsm";
 
   log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
   // directory or file does not exist
@@ -49,27 +95,39 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     }
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  // create the file if it does not exist, but never truncate an existing database
+  if (direct_io) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    direct_io_ = db_fd_ >= 0;
+    if (!direct_io_) {
+      // e.g. tmpfs, which has no O_DIRECT
+      LOG_WARN("can't open db file with O_DIRECT, falling back to buffered I/O");
     }
   }
+  if (db_fd_ < 0) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  LoadFreePageMap();
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+  }
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+  if (db_fd_ >= 0) {
+    SyncPages();
+    close(db_fd_);
+    db_fd_ = -1;
   }
   log_io_.close();
 }
@@ -78,48 +136,283 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-  // set write cursor to offset
-  num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, BUSTUB_PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
+  if (!IsAligned(page_data)) {
+    AlignedPage aligned;
+    memcpy(aligned.data_, page_data, BUSTUB_PAGE_SIZE);
+    WritePage(page_id, aligned.data_);
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  std::shared_lock truncate_lock(truncate_latch_);
+  auto offset = static_cast<off_t>(page_id) * BUSTUB_PAGE_SIZE;
+  num_writes_ += 1;
+  size_t written = 0;
+  while (written < BUSTUB_PAGE_SIZE) {
+    ssize_t ret = pwrite(db_fd_, page_data + written, BUSTUB_PAGE_SIZE - written, offset + written);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    // check for I/O error
+    if (ret <= 0) {
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    written += ret;
+  }
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * BUSTUB_PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, BUSTUB_PAGE_SIZE);
-    if (db_io_.bad()) {
+  if (!IsAligned(page_data)) {
+    AlignedPage aligned;
+    ReadPage(page_id, aligned.data_);
+    memcpy(page_data, aligned.data_, BUSTUB_PAGE_SIZE);
+    return;
+  }
+  auto offset = static_cast<off_t>(page_id) * BUSTUB_PAGE_SIZE;
+  size_t read_count = 0;
+  while (read_count < BUSTUB_PAGE_SIZE) {
+    ssize_t ret = pread(db_fd_, page_data + read_count, BUSTUB_PAGE_SIZE - read_count, offset + read_count);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret < 0) {
       LOG_DEBUG("I/O error while reading");
       return;
     }
-    // if file ends before reading BUSTUB_PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < BUSTUB_PAGE_SIZE) {
+    if (ret == 0) {
+      // the file ends before the page does, the rest of it was never written
       LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
       memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+      return;
+    }
+    read_count += ret;
+  }
+}
+
+/**
+ * Write the contents of adjacent pages into disk file
+ */
+auto DiskManager::WritePages(page_id_t first_page_id, const char *const *pages_data, size_t count) -> bool {
+  // Without a file (DiskManagerMemory), for a single page, or for buffers that need an aligned copy, go through
+  // WritePage(), which subclasses override.
+  if (db_fd_ < 0 || count == 1 || !std::all_of(pages_data, pages_data + count, [&](auto d) { return IsAligned(d); })) {
+    for (size_t i = 0; i < count; ++i) {
+      WritePage(first_page_id + i, pages_data[i]);
+    }
+    return true;
+  }
+  std::shared_lock truncate_lock(truncate_latch_);
+  num_writes_ += count;
+  std::vector<struct iovec> iov(count);
+  for (size_t i = 0; i < count; ++i) {
+    iov[i].iov_base = const_cast<char *>(pages_data[i]);  // NOLINT
+    iov[i].iov_len = BUSTUB_PAGE_SIZE;
+  }
+  auto offset = static_cast<off_t>(first_page_id) * BUSTUB_PAGE_SIZE;
+  if (TransferPages(true, db_fd_, iov.data(), iov.size(), offset) != static_cast<ssize_t>(count * BUSTUB_PAGE_SIZE)) {
+    LOG_DEBUG("I/O error while writing");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Read the contents of adjacent pages into the given memory areas
+ */
+auto DiskManager::ReadPages(page_id_t first_page_id, char *const *pages_data, size_t count) -> bool {
+  if (db_fd_ < 0 || count == 1 || !std::all_of(pages_data, pages_data + count, [&](auto d) { return IsAligned(d); })) {
+    for (size_t i = 0; i < count; ++i) {
+      ReadPage(first_page_id + i, pages_data[i]);
+    }
+    return true;
+  }
+  std::vector<struct iovec> iov(count);
+  for (size_t i = 0; i < count; ++i) {
+    iov[i].iov_base = pages_data[i];
+    iov[i].iov_len = BUSTUB_PAGE_SIZE;
+  }
+  auto offset = static_cast<off_t>(first_page_id) * BUSTUB_PAGE_SIZE;
+  ssize_t read_count = TransferPages(false, db_fd_, iov.data(), iov.size(), offset);
+  if (read_count < 0) {
+    LOG_DEBUG("I/O error while reading");
+    return false;
+  }
+  // the file may end before the last pages do, the rest of them was never written
+  for (size_t i = 0; i < count; ++i) {
+    auto page_begin = static_cast<ssize_t>(i * BUSTUB_PAGE_SIZE);
+    if (read_count < page_begin + BUSTUB_PAGE_SIZE) {
+      ssize_t valid = std::max<ssize_t>(read_count - page_begin, 0);
+      memset(pages_data[i] + valid, 0, BUSTUB_PAGE_SIZE - valid);
+    }
+  }
+  return true;
+}
+
+/**
+ * Force the written pages of the db file to disk
+ */
+void DiskManager::SyncPages() {
+  if (db_fd_ >= 0 && fdatasync(db_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+  std::scoped_lock free_map_lock(free_map_latch_);
+  SaveFreePageMap();
+}
+
+/**
+ * Mark a page as free in the free-page map
+ */
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  BUSTUB_ASSERT(page_id >= 0, "invalid page id");
+  std::scoped_lock free_map_lock(free_map_latch_);
+  size_t word = page_id / 64;
+  uint64_t bit = uint64_t{1} << (page_id % 64);
+  if (word >= free_map_.size()) {
+    free_map_.resize(word + 1, 0);
+  }
+  if ((free_map_[word] & bit) == 0) {
+    free_map_[word] |= bit;
+    num_free_pages_++;
+    free_map_dirty_ = true;
+  }
+}
+
+/**
+ * Take the lowest free page of the given shard out of the free-page map
+ */
+auto DiskManager::AllocateFreePage(uint32_t stride, uint32_t residue) -> page_id_t {
+  std::scoped_lock free_map_lock(free_map_latch_);
+  if (num_free_pages_ == 0) {
+    return INVALID_PAGE_ID;
+  }
+  for (size_t word = 0; word < free_map_.size(); ++word) {
+    uint64_t bits = free_map_[word];
+    while (bits != 0) {
+      int i = __builtin_ctzll(bits);
+      auto page_id = static_cast<page_id_t>(word * 64 + i);
+      if (static_cast<uint32_t>(page_id) % stride == residue) {
+        free_map_[word] &= ~(uint64_t{1} << i);
+        num_free_pages_--;
+        free_map_dirty_ = true;
+        return page_id;
+      }
+      bits &= bits - 1;
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+/**
+ * Returns true if the page is in the free-page map
+ */
+auto DiskManager::IsPageFree(page_id_t page_id) -> bool {
+  std::scoped_lock free_map_lock(free_map_latch_);
+  size_t word = page_id / 64;
+  return page_id >= 0 && word < free_map_.size() && (free_map_[word] & (uint64_t{1} << (page_id % 64))) != 0;
+}
+
+/**
+ * Returns the number of free pages
+ */
+auto DiskManager::GetNumFreePages() -> size_t {
+  std::scoped_lock free_map_lock(free_map_latch_);
+  return num_free_pages_;
+}
+
+/**
+ * Returns the size of the db file in pages, counting a partial page at the end
+ */
+auto DiskManager::GetNumPages() -> page_id_t {
+  struct stat stat_buf;
+  if (db_fd_ < 0 || fstat(db_fd_, &stat_buf) != 0) {
+    return 0;
+  }
+  return static_cast<page_id_t>((stat_buf.st_size + BUSTUB_PAGE_SIZE - 1) / BUSTUB_PAGE_SIZE);
+}
+
+/**
+ * Truncate the free pages at the end of the db file
+ */
+auto DiskManager::Compact() -> size_t {
+  // Hold the map still, so that no page of the tail is allocated, and hold off writes, which could extend the file
+  // while it is cut.
+  std::scoped_lock free_map_lock(free_map_latch_, truncate_latch_);
+  page_id_t num_pages = GetNumPages();
+  page_id_t new_num_pages = num_pages;
+  while (new_num_pages > 0) {
+    page_id_t page_id = new_num_pages - 1;
+    size_t word = page_id / 64;
+    if (word >= free_map_.size() || (free_map_[word] & (uint64_t{1} << (page_id % 64))) == 0) {
+      break;
+    }
+    new_num_pages--;
+  }
+  if (new_num_pages == num_pages) {
+    return 0;
+  }
+  if (ftruncate(db_fd_, static_cast<off_t>(new_num_pages) * BUSTUB_PAGE_SIZE) != 0) {
+    LOG_DEBUG("I/O error while truncating");
+    return 0;
+  }
+  return num_pages - new_num_pages;
+}
+
+void DiskManager::LoadFreePageMap() {
+  std::scoped_lock free_map_lock(free_map_latch_);
+  int fd = open(fsm_name_.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) == 0) {
+    free_map_.resize(stat_buf.st_size / sizeof(uint64_t));
+    auto size = static_cast<ssize_t>(free_map_.size() * sizeof(uint64_t));
+    if (pread(fd, free_map_.data(), size, 0) != size) {
+      LOG_DEBUG("I/O error while reading the free-page map");
+      free_map_.clear();
     }
   }
+  close(fd);
+  // Pages beyond the end of the file are allocated afresh by the buffer pool, so they must not be reused as well. This
+  // also drops a stale map left next to a new database file.
+  page_id_t num_pages = GetNumPages();
+  for (size_t word = 0; word < free_map_.size(); ++word) {
+    for (int i = 0; i < 64; ++i) {
+      uint64_t bit = uint64_t{1} << i;
+      if ((free_map_[word] & bit) == 0) {
+        continue;
+      }
+      if (static_cast<page_id_t>(word * 64 + i) >= num_pages) {
+        free_map_[word] &= ~bit;
+        free_map_dirty_ = true;
+      } else {
+        num_free_pages_++;
+      }
+    }
+  }
+}
+
+void DiskManager::SaveFreePageMap() {
+  if (!free_map_dirty_ || fsm_name_.empty()) {
+    return;
+  }
+  // Write a new map and rename it over the old one, so that a crash leaves one or the other.
+  std::string tmp_name = fsm_name_ + ".tmp";
+  int fd = open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    LOG_DEBUG("can't open the free-page map");
+    return;
+  }
+  auto size = static_cast<ssize_t>(free_map_.size() * sizeof(uint64_t));
+  bool ok = pwrite(fd, free_map_.data(), size, 0) == size && fdatasync(fd) == 0;
+  close(fd);
+  if (ok && rename(tmp_name.c_str(), fsm_name_.c_str()) == 0) {
+    free_map_dirty_ = false;
+  } else {
+    LOG_DEBUG("I/O error while writing the free-page map");
+  }
 }
 
 /**
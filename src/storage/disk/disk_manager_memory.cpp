@@ -12,10 +12,12 @@
 
 #include "storage/disk/disk_manager_memory.h"
 
+#include <sys/mman.h>
 #include <cassert>
 #include <cstddef>
 #include <cstring>
 #include <iostream>
+#include <shared_mutex>
 #include <string>
 #include <thread>  // NOLINT
 
@@ -27,24 +29,73 @@ namespace bustub {
 /**
  * Constructor: used for memory based manager
  */
-DiskManagerMemory::DiskManagerMemory(size_t pages) { memory_ = new char[pages * BUSTUB_PAGE_SIZE]; }
+DiskManagerMemory::DiskManagerMemory(size_t pages) : segments_(new std::atomic<char *>[MAX_SEGMENTS]()) {
+  for (size_t page = 0; page < pages; page += PAGES_PER_SEGMENT) {
+    GetSegment(static_cast<page_id_t>(page), true);
+  }
+}
+
+DiskManagerMemory::~DiskManagerMemory() {
+  for (size_t i = 0; i < MAX_SEGMENTS; ++i) {
+    char *segment = segments_[i].load();
+    if (segment != nullptr) {
+      munmap(segment, PAGES_PER_SEGMENT * BUSTUB_PAGE_SIZE);
+    }
+  }
+}
+
+auto DiskManagerMemory::GetSegment(page_id_t page_id, bool create) -> char * {
+  size_t index = static_cast<size_t>(page_id) / PAGES_PER_SEGMENT;
+  if (index >= MAX_SEGMENTS) {
+    if (create) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "page id beyond the capacity of DiskManagerMemory");
+    }
+    return nullptr;
+  }
+  char *segment = segments_[index].load(std::memory_order_acquire);
+  if (segment != nullptr || !create) {
+    return segment;
+  }
+  // Map a zeroed segment; the OS only backs the pages of it that are written.
+  void *mapping = mmap(nullptr, PAGES_PER_SEGMENT * BUSTUB_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (mapping == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map a DiskManagerMemory segment");
+  }
+  // Another thread may have mapped the segment meanwhile; keep theirs.
+  if (!segments_[index].compare_exchange_strong(segment, static_cast<char *>(mapping), std::memory_order_acq_rel)) {
+    munmap(mapping, PAGES_PER_SEGMENT * BUSTUB_PAGE_SIZE);
+    return segment;
+  }
+  num_segments_++;
+  return static_cast<char *>(mapping);
+}
 
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManagerMemory::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-  // set write cursor to offset
+  BUSTUB_ASSERT(page_id >= 0, "invalid page id");
+  char *segment = GetSegment(page_id, true);
+  size_t offset = static_cast<size_t>(page_id) % PAGES_PER_SEGMENT * BUSTUB_PAGE_SIZE;
   num_writes_ += 1;
-  memcpy(memory_ + offset, page_data, BUSTUB_PAGE_SIZE);
+  std::unique_lock<std::shared_mutex> lock(stripes_[page_id % NUM_STRIPES]);
+  memcpy(segment + offset, page_data, BUSTUB_PAGE_SIZE);
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManagerMemory::ReadPage(page_id_t page_id, char *page_data) {
-  int64_t offset = static_cast<int64_t>(page_id) * BUSTUB_PAGE_SIZE;
-  memcpy(page_data, memory_ + offset, BUSTUB_PAGE_SIZE);
+  char *segment = page_id < 0 ? nullptr : GetSegment(page_id, false);
+  if (segment == nullptr) {
+    // never written
+    memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    return;
+  }
+  size_t offset = static_cast<size_t>(page_id) % PAGES_PER_SEGMENT * BUSTUB_PAGE_SIZE;
+  std::shared_lock<std::shared_mutex> lock(stripes_[page_id % NUM_STRIPES]);
+  memcpy(page_data, segment + offset, BUSTUB_PAGE_SIZE);
 }
 
 }  // namespace bustub
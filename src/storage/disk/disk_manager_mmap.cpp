@@ -0,0 +1,162 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.cpp
+//
+// Identification: src/storage/disk/disk_manager_mmap.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_mmap.h"
+
+#include <sys/mman.h>
+#include <cstring>
+#include <string>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+DiskManagerMmap::DiskManagerMmap(const std::string &db_file) : DiskManager(db_file) {}
+
+DiskManagerMmap::~DiskManagerMmap() {
+  for (char *chunk : chunks_) {
+    if (chunk != nullptr) {
+      munmap(chunk, MMAP_CHUNK_PAGES * BUSTUB_PAGE_SIZE);
+    }
+  }
+}
+
+void DiskManagerMmap::WriteUnviewed(std::unique_lock<std::mutex> *lock, page_id_t page_id, const char *page_data) {
+  view_counts_[page_id] = WRITING;
+  lock->unlock();
+  DiskManager::WritePage(page_id, page_data);
+  lock->lock();
+  view_counts_.erase(page_id);
+  write_cv_.notify_all();
+}
+
+void DiskManagerMmap::WaitForWrite(std::unique_lock<std::mutex> *lock, page_id_t page_id) {
+  write_cv_.wait(*lock, [&] {
+    auto it = view_counts_.find(page_id);
+    return it == view_counts_.end() || it->second != WRITING;
+  });
+}
+
+void DiskManagerMmap::WritePage(page_id_t page_id, const char *page_data) {
+  std::unique_lock<std::mutex> lock(view_latch_);
+  // A deferred write may be landing; ours is newer, so it must land after it.
+  WaitForWrite(&lock, page_id);
+  if (view_counts_.count(page_id) != 0) {
+    auto &deferred = deferred_writes_[page_id];
+    if (deferred == nullptr) {
+      deferred = std::make_unique<char[]>(BUSTUB_PAGE_SIZE);
+    }
+    memcpy(deferred.get(), page_data, BUSTUB_PAGE_SIZE);
+    return;
+  }
+  WriteUnviewed(&lock, page_id, page_data);
+}
+
+void DiskManagerMmap::ReadPage(page_id_t page_id, char *page_data) {
+  std::unique_lock<std::mutex> lock(view_latch_);
+  // A deferred write that is landing has left deferred_writes_, but is not on disk yet.
+  WaitForWrite(&lock, page_id);
+  auto it = deferred_writes_.find(page_id);
+  if (it != deferred_writes_.end()) {
+    memcpy(page_data, it->second.get(), BUSTUB_PAGE_SIZE);
+    return;
+  }
+  lock.unlock();
+  DiskManager::ReadPage(page_id, page_data);
+}
+
+auto DiskManagerMmap::WritePages(page_id_t first_page_id, const char *const *pages_data, size_t count) -> bool {
+  for (size_t i = 0; i < count; ++i) {
+    WritePage(first_page_id + static_cast<page_id_t>(i), pages_data[i]);
+  }
+  return true;
+}
+
+auto DiskManagerMmap::ReadPages(page_id_t first_page_id, char *const *pages_data, size_t count) -> bool {
+  for (size_t i = 0; i < count; ++i) {
+    ReadPage(first_page_id + static_cast<page_id_t>(i), pages_data[i]);
+  }
+  return true;
+}
+
+auto DiskManagerMmap::AcquirePageView(page_id_t page_id) -> const char * {
+  std::scoped_lock lock(view_latch_);
+  if (page_id < 0 || db_fd_ < 0) {
+    return nullptr;
+  }
+  auto it = view_counts_.find(page_id);
+  if (it != view_counts_.end() && it->second == WRITING) {
+    return nullptr;
+  }
+  if (page_id >= num_file_pages_) {
+    // Touching the mapping beyond the end of the file faults, so only hand out pages the file already has.
+    num_file_pages_ = GetNumPages();
+    if (page_id >= num_file_pages_) {
+      return nullptr;
+    }
+  }
+  size_t index = static_cast<size_t>(page_id) / MMAP_CHUNK_PAGES;
+  if (index >= chunks_.size()) {
+    chunks_.resize(index + 1, nullptr);
+  }
+  if (chunks_[index] == nullptr) {
+    // The chunk may reach beyond the end of the file; those pages become readable as the file grows.
+    void *mapping = mmap(nullptr, MMAP_CHUNK_PAGES * BUSTUB_PAGE_SIZE, PROT_READ, MAP_SHARED, db_fd_,
+                         static_cast<off_t>(index * MMAP_CHUNK_PAGES * BUSTUB_PAGE_SIZE));
+    if (mapping == MAP_FAILED) {
+      LOG_DEBUG("can't map the database file");
+      return nullptr;
+    }
+    chunks_[index] = static_cast<char *>(mapping);
+  }
+  view_counts_[page_id]++;
+  return chunks_[index] + static_cast<size_t>(page_id) % MMAP_CHUNK_PAGES * BUSTUB_PAGE_SIZE;
+}
+
+void DiskManagerMmap::ReleasePageView(page_id_t page_id) {
+  std::unique_lock<std::mutex> lock(view_latch_);
+  auto it = view_counts_.find(page_id);
+  BUSTUB_ASSERT(it != view_counts_.end() && it->second > 0, "page has no view to release");
+  if (--it->second > 0) {
+    return;
+  }
+  view_counts_.erase(it);
+  auto deferred = deferred_writes_.find(page_id);
+  if (deferred == deferred_writes_.end()) {
+    return;
+  }
+  // The last reader is gone, so the write held back for it can land now.
+  std::unique_ptr<char[]> data = std::move(deferred->second);
+  deferred_writes_.erase(deferred);
+  WriteUnviewed(&lock, page_id, data.get());
+}
+
+auto DiskManagerMmap::Compact() -> size_t {
+  std::scoped_lock lock(view_latch_);
+  if (!view_counts_.empty()) {
+    return 0;
+  }
+  size_t shrunk = DiskManager::Compact();
+  num_file_pages_ = 0;
+  return shrunk;
+}
+
+auto DiskManagerMmap::GetNumViewedPages() -> size_t {
+  std::scoped_lock lock(view_latch_);
+  size_t viewed = 0;
+  for (const auto &[page_id, count] : view_counts_) {
+    viewed += count > 0 ? 1 : 0;
+  }
+  return viewed;
+}
+
+}  // namespace bustub
@@ -0,0 +1,357 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <sys/uio.h>
+#include <algorithm>
+#include <cerrno>
+#include <shared_mutex>
+#include <utility>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define BUSTUB_HAVE_IO_URING
+#endif
+
+#include "common/logger.h"
+
+namespace bustub {
+
+#ifdef BUSTUB_HAVE_IO_URING
+
+/**
+ * A minimal io_uring: one submission and one completion ring, set up and driven through the raw system calls. Only
+ * the worker thread that owns it uses it.
+ */
+class IoUring {
+ public:
+  /** @return true if the kernel lets us set up an io_uring */
+  static auto IsSupported() -> bool {
+    static const bool supported = IoUring(1).IsValid();
+    return supported;
+  }
+
+  explicit IoUring(unsigned entries) {
+    io_uring_params params{};
+    ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring_fd_ < 0) {
+      return;
+    }
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    single_mmap_ = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap_) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                    IORING_OFF_SQ_RING);
+    cq_ring_ = single_mmap_ ? sq_ring_
+                            : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                                   IORING_OFF_CQ_RING);
+    sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+      Close();
+      return;
+    }
+    auto *sq = static_cast<char *>(sq_ring_);
+    auto *cq = static_cast<char *>(cq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    entries_ = params.sq_entries;
+  }
+
+  DISALLOW_COPY_AND_MOVE(IoUring);
+
+  ~IoUring() { Close(); }
+
+  auto IsValid() const -> bool { return ring_fd_ >= 0; }
+
+  /** @return the number of operations that fit in the submission ring */
+  auto GetEntries() const -> unsigned { return entries_; }
+
+  /** @brief Queue a readv or writev. At most GetEntries() operations may be queued before Wait(). */
+  void Prepare(bool is_write, int fd, const struct iovec *iov, unsigned iovcnt, off_t offset, uint64_t user_data) {
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & sq_mask_;
+    io_uring_sqe *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+    *sqe = io_uring_sqe{};
+    sqe->opcode = is_write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->off = offset;
+    sqe->addr = reinterpret_cast<uint64_t>(iov);
+    sqe->len = iovcnt;
+    sqe->user_data = user_data;
+    sq_array_[index] = index;
+    // The kernel must see the entry before the new tail.
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    to_submit_++;
+  }
+
+  /**
+   * @brief Submit the queued operations and wait for all of them.
+   * @param on_complete called with the user_data and the result of each operation
+   */
+  template <typename Callback>
+  void Wait(Callback on_complete) {
+    unsigned outstanding = to_submit_;
+    while (outstanding > 0) {
+      unsigned head = *cq_head_;
+      while (outstanding > 0 && head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+        const io_uring_cqe &cqe = cqes_[head & cq_mask_];
+        on_complete(cqe.user_data, cqe.res);
+        head++;
+        outstanding--;
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+      if (outstanding == 0) {
+        break;
+      }
+      auto ret = syscall(__NR_io_uring_enter, ring_fd_, to_submit_, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (ret < 0) {
+        // EAGAIN and EBUSY mean the kernel is short of resources for now; completions free them up.
+        BUSTUB_ENSURE(errno == EINTR || errno == EAGAIN || errno == EBUSY, "io_uring_enter failed");
+        continue;
+      }
+      to_submit_ -= ret;
+    }
+  }
+
+ private:
+  void Close() {
+    if (sqes_ != nullptr && sqes_ != MAP_FAILED) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != MAP_FAILED && !single_mmap_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr && sq_ring_ != MAP_FAILED) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0) {
+      close(ring_fd_);
+    }
+    ring_fd_ = -1;
+  }
+
+  int ring_fd_{-1};
+  unsigned entries_{0};
+  /** Operations queued by Prepare() that the kernel has not taken yet. */
+  unsigned to_submit_{0};
+  bool single_mmap_{false};
+  void *sq_ring_{nullptr};
+  void *cq_ring_{nullptr};
+  void *sqes_{nullptr};
+  size_t sq_ring_size_{0};
+  size_t cq_ring_size_{0};
+  size_t sqes_size_{0};
+  unsigned *sq_tail_{nullptr};
+  unsigned sq_mask_{0};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned cq_mask_{0};
+  io_uring_cqe *cqes_{nullptr};
+};
+
+#else
+
+/** Stands in for the io_uring backend where there are no io_uring headers; never supported. */
+class IoUring {
+ public:
+  static auto IsSupported() -> bool { return false; }
+};
+
+#endif
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, size_t num_workers, DiskSchedulerBackend backend)
+    : disk_manager_(disk_manager), backend_(backend) {
+  BUSTUB_ASSERT(num_workers > 0, "a disk scheduler needs at least one worker");
+  if (backend_ != DiskSchedulerBackend::THREAD_POOL) {
+    // io_uring goes around WritePage(), which a disk manager with page views needs to see every write.
+    bool has_file = disk_manager_ != nullptr && disk_manager_->db_fd_ >= 0 && !disk_manager_->SupportsPageViews();
+    backend_ = has_file && IoUring::IsSupported() ? DiskSchedulerBackend::IO_URING : DiskSchedulerBackend::THREAD_POOL;
+  }
+  workers_.reserve(num_workers);
+  for (size_t i = 0; i < num_workers; ++i) {
+    workers_.emplace_back(std::make_unique<Worker>());
+  }
+}
+
+DiskScheduler::~DiskScheduler() {
+  for (auto &worker : workers_) {
+    {
+      std::scoped_lock<std::mutex> lock(worker->latch_);
+      worker->stop_ = true;
+    }
+    worker->cv_.notify_one();
+  }
+  for (auto &worker : workers_) {
+    if (worker->thread_.joinable()) {
+      worker->thread_.join();
+    }
+  }
+}
+
+void DiskScheduler::StartWorkers() {
+  std::call_once(start_workers_, [&] {
+    for (auto &worker : workers_) {
+#ifdef BUSTUB_HAVE_IO_URING
+      if (backend_ == DiskSchedulerBackend::IO_URING) {
+        worker->ring_ = std::make_unique<IoUring>(DISK_SCHEDULER_BATCH_SIZE);
+        if (!worker->ring_->IsValid()) {
+          // Out of locked memory or file descriptors; this worker runs its requests itself.
+          worker->ring_ = nullptr;
+        }
+      }
+#endif
+      worker->thread_ = std::thread(&DiskScheduler::WorkerLoop, this, worker.get());
+    }
+  });
+}
+
+auto DiskScheduler::WorkerOf(page_id_t page_id) const -> size_t {
+  BUSTUB_ASSERT(page_id >= 0, "invalid page id");
+  return (page_id / DISK_SCHEDULER_EXTENT_SIZE) % workers_.size();
+}
+
+void DiskScheduler::Schedule(DiskRequest request) {
+  StartWorkers();
+  Worker *worker = workers_[WorkerOf(request.page_id_)].get();
+  {
+    std::scoped_lock<std::mutex> lock(worker->latch_);
+    worker->queue_.emplace_back(std::move(request));
+  }
+  worker->cv_.notify_one();
+}
+
+void DiskScheduler::Schedule(std::vector<DiskRequest> *requests) {
+  StartWorkers();
+  // Hand each worker its share under one acquisition of its latch, so it sees the adjacent pages together.
+  std::vector<std::vector<DiskRequest>> shares(workers_.size());
+  for (auto &request : *requests) {
+    shares[WorkerOf(request.page_id_)].emplace_back(std::move(request));
+  }
+  requests->clear();
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    if (shares[i].empty()) {
+      continue;
+    }
+    {
+      std::scoped_lock<std::mutex> lock(workers_[i]->latch_);
+      for (auto &request : shares[i]) {
+        workers_[i]->queue_.emplace_back(std::move(request));
+      }
+    }
+    workers_[i]->cv_.notify_one();
+  }
+}
+
+void DiskScheduler::WorkerLoop(Worker *worker) {
+  std::vector<DiskRequest> batch;
+  std::unique_lock<std::mutex> lock(worker->latch_);
+  while (true) {
+    worker->cv_.wait(lock, [&] { return worker->stop_ || !worker->queue_.empty(); });
+    if (worker->queue_.empty()) {
+      // Asked to stop, and every request has been run.
+      break;
+    }
+    // Take the queued requests up to the first one for a page already in the batch. All pages of a batch are distinct,
+    // so the batch may run in any order without reordering two requests for the same page.
+    while (!worker->queue_.empty() && batch.size() < DISK_SCHEDULER_BATCH_SIZE) {
+      page_id_t page_id = worker->queue_.front().page_id_;
+      if (std::any_of(batch.begin(), batch.end(), [&](const DiskRequest &r) { return r.page_id_ == page_id; })) {
+        break;
+      }
+      batch.emplace_back(std::move(worker->queue_.front()));
+      worker->queue_.pop_front();
+    }
+    lock.unlock();
+
+    std::sort(batch.begin(), batch.end(),
+              [](const DiskRequest &a, const DiskRequest &b) { return a.page_id_ < b.page_id_; });
+    RunBatch(worker, &batch);
+    batch.clear();
+
+    lock.lock();
+  }
+}
+
+void DiskScheduler::RunBatch(Worker *worker, std::vector<DiskRequest> *batch) {
+  // Split the batch into runs of adjacent pages in the same direction: requests [runs[i], runs[i + 1]).
+  std::vector<size_t> runs{0};
+  for (size_t i = 1; i < batch->size(); ++i) {
+    const DiskRequest &prev = (*batch)[i - 1];
+    const DiskRequest &cur = (*batch)[i];
+    if (cur.page_id_ != prev.page_id_ + 1 || cur.is_write_ != prev.is_write_) {
+      runs.push_back(i);
+    }
+  }
+  runs.push_back(batch->size());
+  std::vector<bool> done(runs.size() - 1, false);
+
+#ifdef BUSTUB_HAVE_IO_URING
+  if (worker->ring_ != nullptr) {
+    std::vector<struct iovec> iov(batch->size());
+    for (size_t i = 0; i < batch->size(); ++i) {
+      iov[i].iov_base = (*batch)[i].data_;
+      iov[i].iov_len = BUSTUB_PAGE_SIZE;
+    }
+    int fd = disk_manager_->db_fd_;
+    // Writes must not race with DiskManager::Compact() cutting the file, just like those of WritePage().
+    std::shared_lock truncate_lock(disk_manager_->truncate_latch_);
+    for (size_t r = 0; r + 1 < runs.size(); ++r) {
+      size_t begin = runs[r];
+      auto offset = static_cast<off_t>((*batch)[begin].page_id_) * BUSTUB_PAGE_SIZE;
+      worker->ring_->Prepare((*batch)[begin].is_write_, fd, &iov[begin], runs[r + 1] - begin, offset, r);
+    }
+    worker->ring_->Wait([&](uint64_t r, int32_t res) {
+      // A short transfer (a read past the end of the file, or a partial write) is finished by RunSync() below.
+      done[r] = res == static_cast<int32_t>((runs[r + 1] - runs[r]) * BUSTUB_PAGE_SIZE);
+      if (done[r] && (*batch)[runs[r]].is_write_) {
+        disk_manager_->num_writes_ += runs[r + 1] - runs[r];
+      }
+    });
+  }
+#endif
+
+  for (size_t r = 0; r + 1 < runs.size(); ++r) {
+    bool ok = done[r] || RunSync(batch, runs[r], runs[r + 1]);
+    for (size_t i = runs[r]; i < runs[r + 1]; ++i) {
+      (*batch)[i].callback_.set_value(ok);
+    }
+  }
+}
+
+auto DiskScheduler::RunSync(std::vector<DiskRequest> *batch, size_t begin, size_t end) -> bool {
+  std::vector<char *> pages_data;
+  pages_data.reserve(end - begin);
+  for (size_t i = begin; i < end; ++i) {
+    pages_data.push_back((*batch)[i].data_);
+  }
+  page_id_t first_page_id = (*batch)[begin].page_id_;
+  if ((*batch)[begin].is_write_) {
+    return disk_manager_->WritePages(first_page_id, pages_data.data(), pages_data.size());
+  }
+  return disk_manager_->ReadPages(first_page_id, pages_data.data(), pages_data.size());
+}
+
+}  // namespace bustub
@@ -32,14 +32,19 @@ auto INDEXITERATOR_TYPE::IsEnd() -> bool { return it_page_id_ == INVALID_PAGE_ID
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
-  auto tmp = reinterpret_cast<LeafPage *>(buffer_pool_manager_->FetchPage(it_page_id_));
+  auto tmp = reinterpret_cast<LeafPage *>(buffer_pool_manager_->FetchPage(it_page_id_)->GetData());
   buffer_pool_manager_->UnpinPage(it_page_id_, false);
   return tmp->PairAt(offset_);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
-  auto tmp = reinterpret_cast<LeafPage *>(buffer_pool_manager_->FetchPage(it_page_id_));
+  auto tmp = reinterpret_cast<LeafPage *>(buffer_pool_manager_->FetchPage(it_page_id_)->GetData());
+  if (offset_ == 0 && tmp->GetNextPageId() != INVALID_PAGE_ID) {
+    // Leaf page ids follow split order rather than key order, so the only page worth reading ahead is the next leaf.
+    // Start reading it as soon as the scan enters this one.
+    buffer_pool_manager_->PrefetchPages(tmp->GetNextPageId(), 1);
+  }
   page_id_t next_page_id;
   if (offset_ < tmp->GetSize() - 1) {
     next_page_id = it_page_id_;
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer replacer(4);
+
+  // Scenario: load pages 0..3 into frames 0..3, then access 0 and 1 again. T1 = [2,3], T2 = [0,1].
+  for (int i = 0; i < 4; ++i) {
+    replacer.RecordLoad(i, i);
+    replacer.RecordAccess(i);
+    replacer.SetEvictable(i, true);
+  }
+  replacer.RecordAccess(0);
+  replacer.RecordAccess(1);
+  ASSERT_EQ(4, replacer.Size());
+  ASSERT_EQ(0, replacer.GetTarget());
+
+  // Scenario: T1 is above its target, so the victim is its LRU frame.
+  int value;
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+
+  // Scenario: page 2 comes back while in B1. T1 should grow, and the page goes to T2 = [0,1,2].
+  replacer.RecordLoad(2, 2);
+  replacer.RecordAccess(2);
+  replacer.SetEvictable(2, true);
+  ASSERT_EQ(1, replacer.GetTarget());
+
+  // Scenario: T1 = [3] is within its target, so the victim is the LRU frame of T2.
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Scenario: page 0 comes back while in B2. T2 should grow.
+  replacer.RecordLoad(0, 0);
+  replacer.RecordAccess(0);
+  replacer.SetEvictable(0, true);
+  ASSERT_EQ(0, replacer.GetTarget());
+
+  // Scenario: a scan only churns through T1. It touches each page once per tuple, but those re-references are
+  // correlated with the load and do not move the page to T2.
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(true, replacer.Evict(&value));
+    ASSERT_EQ(3, value);
+    replacer.RecordLoad(value, 100 + i);
+    replacer.RecordAccess(value);
+    replacer.SetEvictable(value, true);
+    for (int tuple = 0; tuple < 3; ++tuple) {
+      replacer.SetEvictable(value, false);
+      replacer.RecordAccess(value);
+      replacer.SetEvictable(value, true);
+    }
+  }
+  ASSERT_EQ(std::vector<frame_id_t>({3, 1, 2, 0}), replacer.EvictionCandidates(10));
+
+  // Scenario: pinned frames are skipped.
+  replacer.SetEvictable(3, false);
+  ASSERT_EQ(3, replacer.Size());
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+  replacer.Remove(2);
+  ASSERT_EQ(1, replacer.Size());
+}
+
+}  // namespace bustub
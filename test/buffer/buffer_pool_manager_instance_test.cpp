@@ -12,12 +12,19 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
 #include <cstdio>
+#include <mutex>  // NOLINT
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_mmap.h"
 
 namespace bustub {
 
@@ -145,4 +152,829 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   delete disk_manager;
 }
 
+// Many threads missing on a small pool at once: every dirty write-back must reach the disk before the page is re-read.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t k = 2;
+  const int num_pages = 20;
+  const int num_threads = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<int> dist(0, num_pages - 1);
+      char expected[32];
+      for (int i = 0; i < 200; ++i) {
+        page_id_t page_id = dist(rng);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        snprintf(expected, sizeof(expected), "page-%d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// Hits on a pinned page skip the latch; the pin count must still come out exact while other pages churn.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentHitTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+  const int num_pages = 12;
+  const int num_threads = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  // Keep page 0 pinned, so every fetch of it takes the lock-free path.
+  auto *hot_page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, hot_page);
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<int> dist(1, num_pages - 1);
+      char expected[32];
+      for (int i = 0; i < 500; ++i) {
+        page_id_t page_id = i % 2 == 0 ? 0 : dist(rng);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        snprintf(expected, sizeof(expected), "page-%d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: only our own pin is left on page 0, and dropping it makes the frame evictable again.
+  EXPECT_EQ(1, hot_page->GetPinCount());
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(false, bpm->UnpinPage(0, false));
+  for (int i = 0; i < static_cast<int>(buffer_pool_size); ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// A flush in progress must not make the frame it writes unavailable to fetches.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentFlushTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 1;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < 2; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  std::atomic<bool> done = false;
+  std::thread flusher([bpm, &done] {
+    while (!done) {
+      bpm->FlushPage(0);
+      bpm->FlushPage(1);
+    }
+  });
+
+  // Scenario: the only frame is unpinned between fetches, so every fetch finds a victim.
+  char expected[32];
+  for (int i = 0; i < 500; ++i) {
+    page_id_t page_id = i % 2;
+    auto *page = bpm->FetchPage(page_id);
+    EXPECT_NE(nullptr, page);
+    if (page == nullptr) {
+      continue;
+    }
+    snprintf(expected, sizeof(expected), "page-%d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  done = true;
+  flusher.join();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/** A DiskManager whose writes of one page block until the test opens the gate. */
+class GatedDiskManager : public DiskManager {
+ public:
+  explicit GatedDiskManager(const std::string &db_file) : DiskManager(db_file) {}
+
+  void WritePage(page_id_t page_id, const char *page_data) override {
+    if (page_id == gated_page_id_) {
+      std::unique_lock<std::mutex> lock(gate_latch_);
+      writing_ = true;
+      gate_cv_.notify_all();
+      gate_cv_.wait(lock, [&] { return open_; });
+    }
+    DiskManager::WritePage(page_id, page_data);
+  }
+
+  void Close(page_id_t page_id) { gated_page_id_ = page_id; }
+
+  void WaitForWrite() {
+    std::unique_lock<std::mutex> lock(gate_latch_);
+    gate_cv_.wait(lock, [&] { return writing_; });
+  }
+
+  void Open() {
+    std::scoped_lock<std::mutex> lock(gate_latch_);
+    open_ = true;
+    gate_cv_.notify_all();
+  }
+
+ private:
+  std::atomic<page_id_t> gated_page_id_{INVALID_PAGE_ID};
+  std::mutex gate_latch_;
+  std::condition_variable gate_cv_;
+  bool writing_{false};
+  bool open_{false};
+};
+
+// Two misses on the same page must load it into one frame, even if one of them waits for its victim's flush.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentFlushMissTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+  const size_t k = 2;
+
+  auto *disk_manager = new GatedDiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k, nullptr, ReplacerPolicy::LRU);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < 3; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  // Pages 0 and 1 are resident, and page 0 is the next victim.
+  for (page_id_t page_id : {0, 1}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: the first miss on page 2 picks page 0's frame while page 0 is being flushed and waits for the write.
+  // The second miss on page 2 happens while it waits.
+  disk_manager->Close(0);
+  std::thread flusher([bpm] { bpm->FlushPage(0); });
+  disk_manager->WaitForWrite();
+  Page *pages[2];
+  std::thread first([bpm, &pages] { pages[0] = bpm->FetchPage(2); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  std::thread second([bpm, &pages] { pages[1] = bpm->FetchPage(2); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  disk_manager->Open();
+  flusher.join();
+  first.join();
+  second.join();
+
+  ASSERT_NE(nullptr, pages[0]);
+  EXPECT_EQ(pages[0], pages[1]);
+  EXPECT_EQ(0, strcmp(pages[0]->GetData(), "page-2"));
+  EXPECT_EQ(true, bpm->UnpinPage(2, false));
+  EXPECT_EQ(true, bpm->UnpinPage(2, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// The background writer cleans unpinned dirty pages, so later evictions find clean victims.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BackgroundWriterTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+  bpm->RunBackgroundWriter(buffer_pool_size, buffer_pool_size, std::chrono::milliseconds(10));
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: without any flush from us, every page eventually reaches the disk.
+  char data[BUSTUB_PAGE_SIZE];
+  char expected[32];
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    snprintf(expected, sizeof(expected), "page-%zu", i);
+    for (int attempt = 0; attempt < 500; ++attempt) {
+      disk_manager->ReadPage(static_cast<page_id_t>(i), data);
+      if (strcmp(data, expected) == 0) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(0, strcmp(data, expected));
+  }
+
+  // Scenario: the pool is full of clean pages now, so new pages evict without writing anything back.
+  bpm->StopBackgroundWriter();
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetNumCleanEvictions());
+  EXPECT_EQ(0U, bpm->GetNumDirtyEvictions());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// Frames the background writer is cleaning stay available to misses.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BackgroundWriterEvictionTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+  bpm->RunBackgroundWriter(buffer_pool_size, buffer_pool_size, std::chrono::milliseconds(1));
+
+  // Scenario: every page is unpinned dirty right away, so the writer always has the whole pool to clean.
+  page_id_t page_id_temp;
+  for (int i = 0; i < 2000; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: pages that went through the writer read back intact.
+  char expected[32];
+  for (page_id_t page_id = 1990; page_id < 2000; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, sizeof(expected), "page-%d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  bpm->StopBackgroundWriter();
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// Every replacement policy must keep the pool consistent through a full eviction cycle.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ReplacerPolicyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+
+  for (auto policy : {ReplacerPolicy::LRU_K, ReplacerPolicy::LRU, ReplacerPolicy::CLOCK, ReplacerPolicy::TWO_QUEUE,
+                      ReplacerPolicy::ARC}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k, nullptr, policy);
+
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id_temp);
+    }
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      EXPECT_EQ(true, bpm->UnpinPage(static_cast<page_id_t>(i), true));
+    }
+
+    // Scenario: a second round of new pages evicts every page of the first round.
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+    }
+
+    // Scenario: the first round reads back from disk, one page at a time.
+    char expected[32];
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      auto *page = bpm->FetchPage(static_cast<page_id_t>(i));
+      ASSERT_NE(nullptr, page) << ReplacerPolicyToString(policy);
+      snprintf(expected, sizeof(expected), "page-%zu", i);
+      EXPECT_EQ(0, strcmp(page->GetData(), expected)) << ReplacerPolicyToString(policy);
+      EXPECT_EQ(true, bpm->UnpinPage(static_cast<page_id_t>(i), false));
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// A scan through a BufferAccessStrategy must recycle its own ring instead of evicting other pages.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ScanRingTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t hot_pages = 8;
+  const size_t scan_pages = 40;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  char expected[32];
+  for (size_t i = 0; i < scan_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "scan-%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+
+  // The hot pages stay dirty, so evicting any of them would show up as a disk write.
+  std::vector<page_id_t> hot;
+  for (size_t i = 0; i < hot_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "hot-%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    hot.push_back(page_id_temp);
+  }
+  int writes_before_scan = disk_manager->GetNumWrites();
+
+  // Scenario: a scan over four times the pool only cycles through its two-frame ring.
+  BufferAccessStrategy strategy(2);
+  for (size_t i = 0; i < scan_pages; ++i) {
+    auto *page = bpm->FetchPage(static_cast<page_id_t>(i), &strategy);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, sizeof(expected), "scan-%zu", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(static_cast<page_id_t>(i), false));
+  }
+  EXPECT_EQ(writes_before_scan, disk_manager->GetNumWrites());
+  EXPECT_LE(strategy.GetRing().size(), strategy.GetRingSize());
+
+  // Scenario: the hot pages are still resident and unchanged.
+  for (auto page_id : hot) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, sizeof(expected), "hot-%d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(writes_before_scan, disk_manager->GetNumWrites());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// Prefetched pages are read in the background and then found in the pool by later fetches.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  // Pages 0 to 15 are on disk only, pages 16 to 31 fill the pool.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: resident and unallocated pages are not read.
+  bpm->PrefetchPages(16, 4);
+  bpm->PrefetchPages(100, 4);
+  bpm->PrefetchPages(-2, 1);
+  EXPECT_EQ(0, bpm->GetNumPrefetchedPages());
+
+  // Scenario: a read-ahead of four pages completes in the background.
+  bpm->PrefetchPages(0, 4);
+  for (int i = 0; i < 1000 && bpm->GetNumPrefetchedPages() < 4; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(4, bpm->GetNumPrefetchedPages());
+
+  // Scenario: fetches right after a read-ahead wait for the reads still in flight.
+  bpm->PrefetchPages(4, 4);
+  char expected[32];
+  for (page_id_t page_id = 0; page_id < 8; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, sizeof(expected), "page-%d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(8, bpm->GetNumPrefetchedPages());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// Every fetch, eviction and disk I/O shows up in the stats.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, StatsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  // Scenario: three new pages in a two-frame pool; the third evicts the dirty first page.
+  page_id_t page_id_temp;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  // Scenario: a hit, a miss that evicts dirty page 1, and a miss that fails because every frame is pinned.
+  ASSERT_NE(nullptr, bpm->FetchPage(2));
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(nullptr, bpm->FetchPage(1));
+  EXPECT_EQ(true, bpm->FlushPage(2));
+
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(3, stats.Get(BufferPoolCounter::NEW_PAGES));
+  EXPECT_EQ(1, stats.Get(BufferPoolCounter::FETCH_HITS));
+  EXPECT_EQ(2, stats.Get(BufferPoolCounter::FETCH_MISSES));
+  EXPECT_EQ(2, stats.Get(BufferPoolCounter::DIRTY_EVICTIONS));
+  EXPECT_EQ(0, stats.Get(BufferPoolCounter::CLEAN_EVICTIONS));
+  EXPECT_EQ(1, stats.Get(BufferPoolCounter::FAILED_EVICTIONS));
+  EXPECT_EQ(1, stats.Get(BufferPoolCounter::FLUSHES));
+  EXPECT_EQ(1, stats.GetReadLatency().GetCount());
+  EXPECT_EQ(3, stats.GetWriteLatency().GetCount());
+  EXPECT_LE(stats.GetWriteLatency().GetPercentile(50), stats.GetWriteLatency().GetPercentile(100));
+
+  // Scenario: stats add up, e.g. across the shards of a parallel pool.
+  stats += bpm->GetStats();
+  EXPECT_EQ(6, stats.Get(BufferPoolCounter::NEW_PAGES));
+  EXPECT_EQ(6, stats.GetWriteLatency().GetCount());
+
+  // Scenario: percentiles are upper bounds of power-of-two microsecond buckets.
+  LatencyHistogram histogram;
+  EXPECT_EQ(0, histogram.GetPercentile(50));
+  for (int i = 0; i < 9; ++i) {
+    histogram.Record(std::chrono::microseconds(3));
+  }
+  histogram.Record(std::chrono::milliseconds(1));
+  EXPECT_EQ(10, histogram.GetCount());
+  EXPECT_EQ(4, histogram.GetPercentile(50));
+  EXPECT_EQ(4, histogram.GetPercentile(90));
+  EXPECT_EQ(1024, histogram.GetPercentile(99));
+
+  EXPECT_EQ(true, bpm->UnpinPage(2, false));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// The pool grows and shrinks at runtime, and never takes a pinned frame when it shrinks.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t max_pool_size = 8;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k, nullptr, ReplacerPolicy::LRU_K,
+                                            max_pool_size);
+  EXPECT_EQ(max_pool_size, bpm->GetMaxPoolSize());
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: growing adds free frames.
+  EXPECT_EQ(true, bpm->ResizePool(6));
+  EXPECT_EQ(6, bpm->GetPoolSize());
+  for (size_t i = buffer_pool_size; i < 6; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: shrinking drains the unpinned pages, writing the dirty ones back, and stops at the pinned ones.
+  for (page_id_t page_id = 0; page_id < 3; ++page_id) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  int writes = disk_manager->GetNumWrites();
+  EXPECT_EQ(false, bpm->ResizePool(2));
+  EXPECT_EQ(3, bpm->GetPoolSize());
+  EXPECT_EQ(writes + 3, disk_manager->GetNumWrites());
+  EXPECT_EQ(nullptr, bpm->FetchPage(0));
+
+  // Scenario: once the rest is unpinned, the shrink completes and the drained pages read back from disk.
+  for (page_id_t page_id = 3; page_id < 6; ++page_id) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_EQ(true, bpm->ResizePool(1));
+  EXPECT_EQ(1, bpm->GetPoolSize());
+  char expected[32];
+  for (page_id_t page_id = 0; page_id < 6; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, sizeof(expected), "page-%d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// Resizing while other threads fetch pages must not hand out or free frames in use.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = 32;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k, nullptr, ReplacerPolicy::LRU_K,
+                                            buffer_pool_size);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  std::atomic<bool> done = false;
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 4; ++tid) {
+    readers.emplace_back([bpm, &done, tid] {
+      std::mt19937 rng(tid);
+      std::uniform_int_distribution<page_id_t> pages(0, num_pages - 1);
+      char expected[32];
+      while (!done) {
+        page_id_t page_id = pages(rng);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          // The pool can be down to a few frames, all pinned by the other readers.
+          continue;
+        }
+        snprintf(expected, sizeof(expected), "page-%d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+
+  // Scenario: the pool keeps shrinking and growing under the readers.
+  for (int i = 0; i < 200; ++i) {
+    bpm->ResizePool(i % 2 == 0 ? 5 : buffer_pool_size);
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// Frames are aligned for O_DIRECT, and a pool over a direct I/O disk manager reads back what it evicted.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DirectIoTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name, true);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < 16; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % DIRECT_IO_ALIGNMENT);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  char expected[32];
+  for (page_id_t page_id = 0; page_id < 16; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, sizeof(expected), "page-%d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// Deleted pages are reused by NewPage(), whether they were resident or not when they were deleted.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ReuseDeletedPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+
+  remove("test.fsm");
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  // Page 1 was evicted to disk, page 6 is still resident.
+  EXPECT_EQ(true, bpm->DeletePage(1));
+  EXPECT_EQ(true, bpm->DeletePage(6));
+  EXPECT_EQ(2, disk_manager->GetNumFreePages());
+
+  // Scenario: a prefetch does not make a free page resident.
+  bpm->PrefetchPages(1, 1);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(1, page_id_temp);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(6, page_id_temp);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(8, page_id_temp);
+  EXPECT_EQ(0, disk_manager->GetNumFreePages());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// A read-only scan reads the pages that are not resident in place, and a frame that loads such a page adopts its pins.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PageViewTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+
+  remove("test.fsm");
+  auto *disk_manager = new DiskManagerMmap(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < 8; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page-%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  // Pages 0 to 3 were evicted to disk, pages 4 to 7 are resident.
+  BufferAccessStrategy strategy(2, true);
+  Page *frames = bpm->GetPages();
+  auto in_pool = [&](Page *page) { return page >= frames && page < frames + bpm->GetMaxPoolSize(); };
+
+  // Scenario: a miss of a read-only scan takes no frame, and a resident page is served from its frame as usual.
+  auto *view = bpm->FetchPage(0, &strategy);
+  ASSERT_NE(nullptr, view);
+  EXPECT_FALSE(in_pool(view));
+  EXPECT_EQ(0, strcmp(view->GetData(), "page-0"));
+  EXPECT_EQ(view, bpm->FetchPage(0, &strategy));
+  EXPECT_EQ(2, bpm->GetStats().Get(BufferPoolCounter::PAGE_VIEWS));
+  auto *resident = bpm->FetchPage(5, &strategy);
+  EXPECT_TRUE(in_pool(resident));
+  EXPECT_EQ(true, bpm->UnpinPage(5, false));
+
+  // Scenario: a page read in place is pinned like any other.
+  EXPECT_EQ(false, bpm->DeletePage(0));
+
+  // Scenario: a normal fetch loads the page into a frame, which holds the readers' pins from then on. A write of the
+  // page waits for the readers, who keep seeing the page as it was.
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_TRUE(in_pool(page));
+  EXPECT_EQ(3, page->GetPinCount());
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "changed");
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  EXPECT_EQ(true, bpm->FlushPage(0));
+  EXPECT_EQ(0, strcmp(view->GetData(), "page-0"));
+  char buf[BUSTUB_PAGE_SIZE];
+  disk_manager->ReadPage(0, buf);
+  EXPECT_EQ(0, strcmp(buf, "changed"));
+  EXPECT_EQ(1, disk_manager->GetNumViewedPages());
+
+  // Scenario: once the readers are done, the view is released and the write lands.
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_EQ(0, disk_manager->GetNumViewedPages());
+  const char *data = disk_manager->AcquirePageView(0);
+  ASSERT_NE(nullptr, data);
+  EXPECT_EQ(0, strcmp(data, "changed"));
+  disk_manager->ReleasePageView(0);
+
+  // Scenario: the last unpin of a page read in place releases its view.
+  view = bpm->FetchPage(1, &strategy);
+  ASSERT_NE(nullptr, view);
+  EXPECT_EQ(1, disk_manager->GetNumViewedPages());
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  EXPECT_EQ(false, bpm->UnpinPage(1, false));
+  EXPECT_EQ(0, disk_manager->GetNumViewedPages());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
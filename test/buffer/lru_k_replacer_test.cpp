@@ -97,4 +97,48 @@ TEST(LRUKReplacerTest, SampleTest) {
   lru_replacer.Remove(1);
   ASSERT_EQ(0, lru_replacer.Size());
 }
+
+TEST(LRUKReplacerTest, KDistanceOrderTest) {
+  LRUKReplacer lru_replacer(5, 3);
+
+  // Scenario: frames 0, 1 and 2 are accessed three times each, round-robin. Their k-th most recent accesses are the
+  // first round, so the order is [0,1,2].
+  for (int round = 0; round < 3; ++round) {
+    for (int frame = 0; frame < 3; ++frame) {
+      lru_replacer.RecordAccess(frame);
+    }
+  }
+  // Scenario: one more access to 0 pushes its oldest access out of the history. Now the order is [1,2,0].
+  lru_replacer.RecordAccess(0);
+  // Scenario: frame 3 has a single access, so its backward k-distance is +inf and it goes first: [3,1,2,0].
+  lru_replacer.RecordAccess(3);
+  for (int frame = 0; frame < 4; ++frame) {
+    lru_replacer.SetEvictable(frame, true);
+  }
+  ASSERT_EQ(4, lru_replacer.Size());
+  ASSERT_EQ(std::vector<frame_id_t>({3, 1, 2, 0}), lru_replacer.EvictionCandidates(10));
+  ASSERT_EQ(std::vector<frame_id_t>({3, 1}), lru_replacer.EvictionCandidates(2));
+  ASSERT_EQ(4, lru_replacer.Size());
+
+  // Scenario: non-evictable frames are skipped, and removed frames are gone for good.
+  lru_replacer.SetEvictable(1, false);
+  lru_replacer.Remove(2);
+  ASSERT_EQ(2, lru_replacer.Size());
+  int value;
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ(false, lru_replacer.Evict(&value));
+
+  // Scenario: an evicted frame starts over with an empty history.
+  lru_replacer.RecordAccess(0);
+  lru_replacer.SetEvictable(0, true);
+  lru_replacer.SetEvictable(1, true);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+  ASSERT_EQ(0, lru_replacer.Size());
+}
 }  // namespace bustub
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <atomic>
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  const size_t num_frames = 64;
+  PageTable table(num_frames);
+  std::unordered_map<page_id_t, frame_id_t> expected;
+
+  // Scenario: random inserts and removes, checked against a std::unordered_map.
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<page_id_t> pages(0, 4 * num_frames);
+  for (int i = 0; i < 20000; ++i) {
+    page_id_t page_id = pages(rng);
+    if (expected.count(page_id) != 0) {
+      ASSERT_EQ(true, table.Remove(page_id));
+      expected.erase(page_id);
+    } else if (expected.size() < num_frames) {
+      table.Insert(page_id, static_cast<frame_id_t>(i % num_frames));
+      expected[page_id] = static_cast<frame_id_t>(i % num_frames);
+    }
+    for (page_id_t probe = 0; probe <= static_cast<page_id_t>(4 * num_frames); ++probe) {
+      frame_id_t frame_id;
+      bool found = table.Find(probe, &frame_id);
+      ASSERT_EQ(expected.count(probe) != 0, found) << "page " << probe;
+      if (found) {
+        ASSERT_EQ(expected[probe], frame_id);
+      }
+    }
+  }
+
+  // Scenario: removing a page that is not there does nothing.
+  ASSERT_EQ(false, table.Remove(-5));
+}
+
+TEST(PageTableTest, ConcurrentFindTest) {
+  const size_t num_frames = 16;
+  PageTable table(num_frames);
+  // Page p always lives in frame p % num_frames, so a reader can tell a wrong answer from a stale or missing one.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_frames); ++page_id) {
+    table.Insert(page_id, page_id % num_frames);
+  }
+
+  // The table holds the window [lo, lo + num_frames) of page ids, which the writer keeps sliding forward.
+  std::atomic<page_id_t> lo = 0;
+  std::atomic<bool> done = false;
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 4; ++tid) {
+    readers.emplace_back([&table, &lo, &done, tid] {
+      std::mt19937 rng(tid);
+      std::uniform_int_distribution<page_id_t> offsets(-static_cast<page_id_t>(num_frames), 2 * num_frames);
+      while (!done) {
+        page_id_t page_id = lo + offsets(rng);
+        frame_id_t frame_id;
+        if (page_id >= 0 && table.Find(page_id, &frame_id)) {
+          EXPECT_EQ(page_id % static_cast<page_id_t>(num_frames), frame_id);
+        }
+      }
+    });
+  }
+
+  // Scenario: a single writer keeps replacing pages while readers look them up.
+  for (int i = 0; i < 100000; ++i) {
+    page_id_t oldest = lo;
+    EXPECT_EQ(true, table.Remove(oldest));
+    table.Insert(oldest + num_frames, (oldest + num_frames) % num_frames);
+    lo = oldest + 1;
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+}
+
+}  // namespace bustub
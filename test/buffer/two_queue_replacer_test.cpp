@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer_test.cpp
+//
+// Identification: test/buffer/two_queue_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "buffer/two_queue_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(TwoQueueReplacerTest, SampleTest) {
+  TwoQueueReplacer replacer(8);
+
+  // Scenario: load pages 0..7 into frames 0..7. They all sit in A1in.
+  for (int i = 0; i < 8; ++i) {
+    replacer.RecordLoad(i, i);
+    replacer.RecordAccess(i);
+    replacer.SetEvictable(i, true);
+  }
+  ASSERT_EQ(8, replacer.Size());
+
+  // Scenario: A1in is a FIFO, repeated accesses do not reorder it.
+  replacer.RecordAccess(0);
+  int value;
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Scenario: page 0 comes back while remembered in A1out, so it goes to Am.
+  replacer.RecordLoad(0, 0);
+  replacer.RecordAccess(0);
+  replacer.SetEvictable(0, true);
+  ASSERT_EQ(std::vector<frame_id_t>({1, 2}), replacer.EvictionCandidates(2));
+
+  // Scenario: a long scan keeps A1in full. Its pages replace each other and never the hot page 0.
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_EQ(true, replacer.Evict(&value));
+    ASSERT_NE(0, value);
+    replacer.RecordLoad(value, 1000 + i);
+    replacer.RecordAccess(value);
+    replacer.SetEvictable(value, true);
+  }
+  ASSERT_EQ(8, replacer.Size());
+
+  // Scenario: pinned frames are skipped, removed frames are gone.
+  replacer.SetEvictable(0, false);
+  for (int i = 1; i < 8; ++i) {
+    replacer.Remove(i);
+  }
+  ASSERT_EQ(0, replacer.Size());
+  ASSERT_EQ(false, replacer.Evict(&value));
+  replacer.SetEvictable(0, true);
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ(0, replacer.Size());
+}
+
+}  // namespace bustub
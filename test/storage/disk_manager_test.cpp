@@ -11,10 +11,14 @@
 //===----------------------------------------------------------------------===//
 
 #include <cstring>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_mmap.h"
 
 namespace bustub {
 
@@ -24,12 +28,14 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
   };
 };
 
@@ -72,6 +78,237 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWritePageTest) {
+  const int num_threads = 8;
+  const int pages_per_thread = 64;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Scenario: threads write interleaved pages at once, then read all of them back at once.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&dm, tid] {
+      char data[BUSTUB_PAGE_SIZE];
+      for (int i = 0; i < pages_per_thread; ++i) {
+        page_id_t page_id = i * num_threads + tid;
+        std::memset(data, page_id % 128, sizeof(data));
+        dm.WritePage(page_id, data);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumWrites());
+  dm.SyncPages();
+
+  threads.clear();
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&dm, tid] {
+      char buf[BUSTUB_PAGE_SIZE];
+      char expected[BUSTUB_PAGE_SIZE];
+      for (int i = 0; i < num_threads * pages_per_thread; ++i) {
+        page_id_t page_id = (i + tid * pages_per_thread) % (num_threads * pages_per_thread);
+        std::memset(expected, page_id % 128, sizeof(expected));
+        dm.ReadPage(page_id, buf);
+        EXPECT_EQ(std::memcmp(buf, expected, sizeof(buf)), 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: a page past the end of the file reads as zeros.
+  char buf[BUSTUB_PAGE_SIZE];
+  char zeros[BUSTUB_PAGE_SIZE] = {0};
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(num_threads * pages_per_thread + 10, buf);
+  EXPECT_EQ(std::memcmp(buf, zeros, sizeof(buf)), 0);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIoTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file, true);
+  if (!dm.IsDirectIo()) {
+    GTEST_SKIP() << "the file system does not support O_DIRECT";
+  }
+  alignas(DIRECT_IO_ALIGNMENT) char aligned[2][BUSTUB_PAGE_SIZE];
+  char unaligned_storage[BUSTUB_PAGE_SIZE + 1];
+  char *unaligned = unaligned_storage + 1;
+  char buf[BUSTUB_PAGE_SIZE];
+
+  // Scenario: aligned buffers go straight to the file, unaligned ones through a copy.
+  std::memset(aligned[0], 'a', BUSTUB_PAGE_SIZE);
+  std::memset(unaligned, 'u', BUSTUB_PAGE_SIZE);
+  dm.WritePage(0, aligned[0]);
+  dm.WritePage(1, unaligned);
+  dm.ReadPage(0, unaligned);
+  EXPECT_EQ(std::memcmp(unaligned, aligned[0], BUSTUB_PAGE_SIZE), 0);
+  std::memset(buf, 'u', BUSTUB_PAGE_SIZE);
+  dm.ReadPage(1, aligned[1]);
+  EXPECT_EQ(std::memcmp(aligned[1], buf, BUSTUB_PAGE_SIZE), 0);
+
+  // Scenario: vectored I/O on aligned buffers, reading past the end of the file.
+  char *pages[] = {aligned[0], aligned[1]};
+  EXPECT_TRUE(dm.ReadPages(1, pages, 2));
+  EXPECT_EQ(std::memcmp(aligned[0], buf, BUSTUB_PAGE_SIZE), 0);
+  char zeros[BUSTUB_PAGE_SIZE] = {0};
+  EXPECT_EQ(std::memcmp(aligned[1], zeros, BUSTUB_PAGE_SIZE), 0);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreePageMapTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto *dm = new DiskManager(db_file);
+  for (page_id_t page_id = 0; page_id < 10; ++page_id) {
+    dm->WritePage(page_id, data);
+  }
+
+  // Scenario: freed pages are reused lowest first, and only by the shard they belong to.
+  EXPECT_EQ(INVALID_PAGE_ID, dm->AllocateFreePage());
+  dm->DeallocatePage(3);
+  dm->DeallocatePage(4);
+  dm->DeallocatePage(3);
+  EXPECT_EQ(2, dm->GetNumFreePages());
+  EXPECT_TRUE(dm->IsPageFree(4));
+  EXPECT_EQ(3, dm->AllocateFreePage(2, 1));
+  EXPECT_EQ(INVALID_PAGE_ID, dm->AllocateFreePage(2, 1));
+  EXPECT_EQ(4, dm->AllocateFreePage());
+  EXPECT_FALSE(dm->IsPageFree(4));
+  EXPECT_EQ(0, dm->GetNumFreePages());
+
+  // Scenario: compaction truncates the free pages at the end of the file only, and they stay free.
+  dm->DeallocatePage(5);
+  dm->DeallocatePage(8);
+  dm->DeallocatePage(9);
+  EXPECT_EQ(2, dm->Compact());
+  EXPECT_EQ(8, dm->GetNumPages());
+  EXPECT_EQ(0, dm->Compact());
+  EXPECT_EQ(3, dm->GetNumFreePages());
+
+  // Scenario: the map survives a restart, minus the pages beyond the end of the file, which the buffer pool allocates
+  // afresh.
+  dm->ShutDown();
+  delete dm;
+  dm = new DiskManager(db_file);
+  EXPECT_EQ(1, dm->GetNumFreePages());
+  EXPECT_TRUE(dm->IsPageFree(5));
+  EXPECT_EQ(5, dm->AllocateFreePage());
+  dm->DeallocatePage(2);
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: a map left next to a new database file is ignored.
+  remove("test.db");
+  dm = new DiskManager(db_file);
+  EXPECT_EQ(0, dm->GetNumFreePages());
+  dm->ShutDown();
+  delete dm;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, MemoryGrowTest) {
+  const int num_threads = 8;
+  const int pages_per_thread = 512;
+  DiskManagerMemory dm;
+  EXPECT_EQ(0, dm.GetNumSegments());
+
+  // Scenario: pages that were never written read as zeros, and reading them maps nothing.
+  char buf[BUSTUB_PAGE_SIZE];
+  char zeros[BUSTUB_PAGE_SIZE] = {0};
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(12345, buf);
+  EXPECT_EQ(std::memcmp(buf, zeros, sizeof(buf)), 0);
+  EXPECT_EQ(0, dm.GetNumSegments());
+
+  // Scenario: threads write interleaved pages while others read them back; the store grows as they go.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&dm, tid] {
+      char data[BUSTUB_PAGE_SIZE];
+      for (int i = 0; i < pages_per_thread; ++i) {
+        page_id_t page_id = i * num_threads + tid;
+        std::memset(data, page_id % 128, sizeof(data));
+        dm.WritePage(page_id, data);
+        // A page is either unwritten or whole, never torn.
+        dm.ReadPage(page_id + 1, data);
+        EXPECT_TRUE(data[0] == 0 || data[0] == (page_id + 1) % 128);
+        EXPECT_EQ(data[0], data[BUSTUB_PAGE_SIZE - 1]);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  const int num_pages = num_threads * pages_per_thread;
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+  EXPECT_EQ((num_pages + DiskManagerMemory::PAGES_PER_SEGMENT - 1) / DiskManagerMemory::PAGES_PER_SEGMENT,
+            dm.GetNumSegments());
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    char expected[BUSTUB_PAGE_SIZE];
+    std::memset(expected, page_id % 128, sizeof(expected));
+    dm.ReadPage(page_id, buf);
+    ASSERT_EQ(std::memcmp(buf, expected, sizeof(buf)), 0);
+  }
+
+  // Scenario: a sparse write maps only the segment it lands in.
+  std::memset(buf, 7, sizeof(buf));
+  dm.WritePage(100 * DiskManagerMemory::PAGES_PER_SEGMENT, buf);
+  EXPECT_EQ((num_pages + DiskManagerMemory::PAGES_PER_SEGMENT - 1) / DiskManagerMemory::PAGES_PER_SEGMENT + 1,
+            dm.GetNumSegments());
+  std::memset(buf, 0, sizeof(buf));
+  dm.ReadPage(100 * DiskManagerMemory::PAGES_PER_SEGMENT, buf);
+  EXPECT_EQ(7, buf[BUSTUB_PAGE_SIZE / 2]);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, MmapViewTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManagerMmap(db_file);
+  std::strncpy(data, "A test string.", sizeof(data));
+  dm.WritePage(0, data);
+
+  // Scenario: a view shows the page in place; pages beyond the end of the file have none.
+  const char *view = dm.AcquirePageView(0);
+  ASSERT_NE(nullptr, view);
+  EXPECT_EQ(std::memcmp(view, data, sizeof(data)), 0);
+  EXPECT_EQ(nullptr, dm.AcquirePageView(1));
+  EXPECT_EQ(1, dm.GetNumViewedPages());
+
+  // Scenario: a write of a viewed page is held back, but reads see it.
+  std::strncpy(data, "Another string.", sizeof(data));
+  dm.WritePage(0, data);
+  EXPECT_EQ(0, std::strcmp(view, "A test string."));
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  // Scenario: the file is not cut under a view.
+  dm.DeallocatePage(0);
+  EXPECT_EQ(0, dm.Compact());
+
+  // Scenario: the write lands once the last view is released.
+  dm.ReleasePageView(0);
+  EXPECT_EQ(0, dm.GetNumViewedPages());
+  EXPECT_EQ(2, dm.GetNumWrites());
+  view = dm.AcquirePageView(0);
+  ASSERT_NE(nullptr, view);
+  EXPECT_EQ(std::memcmp(view, data, sizeof(data)), 0);
+  dm.ReleasePageView(0);
+  EXPECT_EQ(1, dm.Compact());
+
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
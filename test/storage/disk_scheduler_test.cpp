@@ -0,0 +1,155 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <cstring>
+#include <future>  // NOLINT
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+class DiskSchedulerTest : public ::testing::TestWithParam<DiskSchedulerBackend> {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_P(DiskSchedulerTest, ScheduleWriteReadPageTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  DiskManager dm("test.db");
+  auto scheduler = std::make_unique<DiskScheduler>(&dm, DISK_SCHEDULER_WORKERS, GetParam());
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // Scenario: a read scheduled right after a write of the same page sees the write.
+  auto write_promise = DiskScheduler::CreatePromise();
+  auto write_done = write_promise.get_future();
+  auto read_promise = DiskScheduler::CreatePromise();
+  auto read_done = read_promise.get_future();
+  scheduler->Schedule({true, data, 0, std::move(write_promise)});
+  scheduler->Schedule({false, buf, 0, std::move(read_promise)});
+  EXPECT_TRUE(write_done.get());
+  EXPECT_TRUE(read_done.get());
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  // Scenario: a page past the end of the file reads as zeros.
+  char zeros[BUSTUB_PAGE_SIZE] = {0};
+  auto past_end_promise = DiskScheduler::CreatePromise();
+  auto past_end_done = past_end_promise.get_future();
+  scheduler->Schedule({false, buf, 100, std::move(past_end_promise)});
+  EXPECT_TRUE(past_end_done.get());
+  EXPECT_EQ(std::memcmp(buf, zeros, sizeof(buf)), 0);
+
+  scheduler = nullptr;
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(DiskSchedulerTest, BatchTest) {
+  const int num_pages = 200;
+  DiskManager dm("test.db");
+  auto scheduler = std::make_unique<DiskScheduler>(&dm, DISK_SCHEDULER_WORKERS, GetParam());
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::vector<char>> bufs(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+
+  // Scenario: a batch of adjacent writes, some for the same page, scheduled out of order. The last write of each page
+  // wins, and runs of adjacent pages are merged, so there are fewer syscalls than pages but every page is counted.
+  std::vector<DiskRequest> requests;
+  std::vector<std::future<bool>> done;
+  for (int i = num_pages - 1; i >= 0; --i) {
+    std::memset(pages[i].data(), i % 128, BUSTUB_PAGE_SIZE);
+    requests.push_back({true, pages[i].data(), i, DiskScheduler::CreatePromise()});
+    done.push_back(requests.back().callback_.get_future());
+  }
+  scheduler->Schedule(&requests);
+  EXPECT_TRUE(requests.empty());
+  for (auto &f : done) {
+    EXPECT_TRUE(f.get());
+  }
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+  // Scenario: read everything back in one batch.
+  done.clear();
+  for (int i = 0; i < num_pages; ++i) {
+    requests.push_back({false, bufs[i].data(), i, DiskScheduler::CreatePromise()});
+    done.push_back(requests.back().callback_.get_future());
+  }
+  scheduler->Schedule(&requests);
+  for (int i = 0; i < num_pages; ++i) {
+    EXPECT_TRUE(done[i].get());
+    EXPECT_EQ(std::memcmp(bufs[i].data(), pages[i].data(), BUSTUB_PAGE_SIZE), 0) << "page " << i;
+  }
+
+  // Scenario: requests for the same page in one batch run in the order they were scheduled.
+  done.clear();
+  char first[BUSTUB_PAGE_SIZE];
+  char second[BUSTUB_PAGE_SIZE];
+  char buf[BUSTUB_PAGE_SIZE];
+  std::memset(first, 'a', sizeof(first));
+  std::memset(second, 'b', sizeof(second));
+  requests.push_back({true, first, 7, DiskScheduler::CreatePromise()});
+  requests.push_back({true, second, 7, DiskScheduler::CreatePromise()});
+  requests.push_back({false, buf, 7, DiskScheduler::CreatePromise()});
+  for (auto &request : requests) {
+    done.push_back(request.callback_.get_future());
+  }
+  scheduler->Schedule(&requests);
+  for (auto &f : done) {
+    EXPECT_TRUE(f.get());
+  }
+  EXPECT_EQ(std::memcmp(buf, second, sizeof(buf)), 0);
+
+  scheduler = nullptr;
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(DiskSchedulerTest, MemoryDiskManagerTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  DiskManagerMemory dm(16);
+  DiskScheduler scheduler(&dm, DISK_SCHEDULER_WORKERS, GetParam());
+  // Scenario: a disk manager without a file always gets the thread pool.
+  EXPECT_EQ(DiskSchedulerBackend::THREAD_POOL, scheduler.GetBackend());
+
+  std::strncpy(data, "A test string.", sizeof(data));
+  auto write_promise = DiskScheduler::CreatePromise();
+  auto write_done = write_promise.get_future();
+  scheduler.Schedule({true, data, 3, std::move(write_promise)});
+  EXPECT_TRUE(write_done.get());
+  auto read_promise = DiskScheduler::CreatePromise();
+  auto read_done = read_promise.get_future();
+  scheduler.Schedule({false, buf, 3, std::move(read_promise)});
+  EXPECT_TRUE(read_done.get());
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(DiskSchedulerBackends, DiskSchedulerTest,
+                         ::testing::Values(DiskSchedulerBackend::THREAD_POOL, DiskSchedulerBackend::AUTO));
+
+}  // namespace bustub
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "fmt/core.h"
+
+namespace {
+
+/**
+ * A mixed workload: point accesses that mostly hit a small hot set, interleaved with long sequential scans over
+ * pages that are never touched otherwise. Scans are what separate the scan-resistant policies from plain LRU. Like
+ * TableIterator, a scan fetches its current page once per tuple, so each scanned page appears tuples_per_page times
+ * in a row.
+ */
+auto MakeMixedTrace(size_t num_frames, size_t num_accesses, size_t tuples_per_page) -> std::vector<bustub::page_id_t> {
+  const size_t oltp_pages = 4 * num_frames;
+  const size_t hot_pages = std::max<size_t>(num_frames / 2, 1);
+  const size_t scan_length = 4 * num_frames;
+  const size_t scan_every = 8 * num_frames;
+
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<size_t> hot(0, hot_pages - 1);
+  std::uniform_int_distribution<size_t> any(0, oltp_pages - 1);
+  std::uniform_int_distribution<int> percent(0, 99);
+
+  std::vector<bustub::page_id_t> trace;
+  trace.reserve(num_accesses);
+  size_t next_scan_page = oltp_pages;
+  while (trace.size() < num_accesses) {
+    if (trace.size() % scan_every == scan_every - 1) {
+      for (size_t i = 0; i < scan_length && trace.size() < num_accesses; i++) {
+        for (size_t j = 0; j < tuples_per_page && trace.size() < num_accesses; j++) {
+          trace.push_back(static_cast<bustub::page_id_t>(next_scan_page));
+        }
+        next_scan_page++;
+      }
+      continue;
+    }
+    size_t page = percent(rng) < 90 ? hot(rng) : any(rng);
+    trace.push_back(static_cast<bustub::page_id_t>(page));
+  }
+  return trace;
+}
+
+auto ReadTrace(const std::string &path, std::vector<bustub::page_id_t> *trace) -> bool {
+  std::ifstream in(path);
+  if (!in.is_open()) {
+    return false;
+  }
+  bustub::page_id_t page_id;
+  while (in >> page_id) {
+    trace->push_back(page_id);
+  }
+  return true;
+}
+
+struct ReplayResult {
+  size_t hits_{0};
+  size_t misses_{0};
+  double ns_per_access_{0};
+};
+
+/** Replay the trace through a pool of num_frames frames, unpinning every page right after the access. */
+auto Replay(bustub::Replacer *replacer, size_t num_frames, const std::vector<bustub::page_id_t> &trace)
+    -> ReplayResult {
+  std::unordered_map<bustub::page_id_t, bustub::frame_id_t> page_table;
+  std::vector<bustub::page_id_t> frame_page(num_frames, bustub::INVALID_PAGE_ID);
+  size_t next_free = 0;
+  ReplayResult result;
+
+  auto start = std::chrono::steady_clock::now();
+  for (auto page_id : trace) {
+    auto it = page_table.find(page_id);
+    if (it != page_table.end()) {
+      result.hits_++;
+      replacer->RecordAccess(it->second);
+      continue;
+    }
+    result.misses_++;
+    bustub::frame_id_t frame_id;
+    if (next_free < num_frames) {
+      frame_id = static_cast<bustub::frame_id_t>(next_free++);
+    } else {
+      if (!replacer->Evict(&frame_id)) {
+        throw std::runtime_error("replacer has no victim although every frame is evictable");
+      }
+      page_table.erase(frame_page[frame_id]);
+    }
+    page_table[page_id] = frame_id;
+    frame_page[frame_id] = page_id;
+    replacer->RecordLoad(frame_id, page_id);
+    replacer->RecordAccess(frame_id);
+    replacer->SetEvictable(frame_id, true);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  result.ns_per_access_ =
+      trace.empty() ? 0 : static_cast<double>(std::chrono::nanoseconds(elapsed).count()) / trace.size();
+  return result;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-replacer-bench");
+  program.add_argument("--trace").help("file of whitespace-separated page ids to replay (default: synthetic mix)");
+  program.add_argument("--frames")
+      .help("number of frames in the simulated buffer pool")
+      .default_value(std::string("1024"));
+  program.add_argument("--accesses").help("length of the synthetic trace").default_value(std::string("1000000"));
+  program.add_argument("--scan-tuples")
+      .help("accesses per page of a synthetic scan")
+      .default_value(std::string("4"));
+  program.add_argument("--k").help("lookback constant of the LRU-K policy").default_value(std::string("2"));
+  program.add_argument("--policy")
+      .help("policy to run: lru_k, lru, clock, 2q, arc or all")
+      .default_value(std::string("all"));
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t num_frames = std::stoul(program.get("--frames"));
+  size_t k = std::stoul(program.get("--k"));
+  if (num_frames == 0 || k == 0) {
+    std::cerr << "--frames and --k must be positive" << std::endl;
+    return 1;
+  }
+
+  std::vector<bustub::page_id_t> trace;
+  if (program.present("--trace")) {
+    if (!ReadTrace(program.get("--trace"), &trace)) {
+      std::cerr << "cannot read trace " << program.get("--trace") << std::endl;
+      return 1;
+    }
+  } else {
+    trace = MakeMixedTrace(num_frames, std::stoul(program.get("--accesses")),
+                           std::max<size_t>(std::stoul(program.get("--scan-tuples")), 1));
+  }
+
+  std::vector<bustub::ReplacerPolicy> policies;
+  if (program.get("--policy") == "all") {
+    policies = {bustub::ReplacerPolicy::LRU_K, bustub::ReplacerPolicy::LRU, bustub::ReplacerPolicy::CLOCK,
+                bustub::ReplacerPolicy::TWO_QUEUE, bustub::ReplacerPolicy::ARC};
+  } else {
+    bustub::ReplacerPolicy policy;
+    if (!bustub::ParseReplacerPolicy(program.get("--policy"), &policy)) {
+      std::cerr << "unknown policy " << program.get("--policy") << std::endl;
+      return 1;
+    }
+    policies = {policy};
+  }
+
+  fmt::print("{} accesses, {} frames\n", trace.size(), num_frames);
+  fmt::print("{:<8}{:>12}{:>12}{:>10}{:>14}\n", "policy", "hits", "misses", "hit%", "ns/access");
+  for (auto policy : policies) {
+    std::unique_ptr<bustub::Replacer> replacer(bustub::MakeReplacer(policy, num_frames, k));
+    auto result = Replay(replacer.get(), num_frames, trace);
+    double hit_ratio = trace.empty() ? 0 : 100.0 * result.hits_ / trace.size();
+    fmt::print("{:<8}{:>12}{:>12}{:>10.2f}{:>14.1f}\n", bustub::ReplacerPolicyToString(policy), result.hits_,
+               result.misses_, hit_ratio, result.ns_per_access_);
+  }
+  return 0;
+}
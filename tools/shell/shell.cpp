@@ -27,24 +27,61 @@ auto GetWidthOfUtf8(const void *beg, const void *end, size_t *width) -> int {
 auto main(int argc, char **argv) -> int {
   ft_set_u8strwid_func(&GetWidthOfUtf8);
 
-  auto bustub = std::make_unique<bustub::BustubInstance>("test.db");
-
   auto default_prompt = "bustub> ";
   auto emoji_prompt = "\U0001f6c1> ";  // the bathtub emoji
   bool use_emoji_prompt = false;
   bool disable_tty = false;
+  auto replacer_policy = bustub::ReplacerPolicy::LRU_K;
+  size_t pool_size = bustub::BUSTUB_INSTANCE_POOL_SIZE;
+  size_t max_pool_size = 0;
+  bool direct_io = false;
+  bool mmap_reads = false;
 
   for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--replacer") == 0 && i + 1 < argc) {
+      if (!bustub::ParseReplacerPolicy(argv[++i], &replacer_policy)) {
+        std::cerr << "unknown replacer policy: " << argv[i] << std::endl;
+        return 1;
+      }
+      continue;
+    }
+    if ((strcmp(argv[i], "--buffer-pool-size") == 0 || strcmp(argv[i], "--max-buffer-pool-size") == 0) &&
+        i + 1 < argc) {
+      bool is_max = strcmp(argv[i], "--max-buffer-pool-size") == 0;
+      char *end = nullptr;
+      size_t size = strtoul(argv[++i], &end, 10);
+      if (*end != '\0' || size == 0) {
+        std::cerr << "invalid buffer pool size: " << argv[i] << std::endl;
+        return 1;
+      }
+      (is_max ? max_pool_size : pool_size) = size;
+      continue;
+    }
+    if (strcmp(argv[i], "--direct-io") == 0) {
+      direct_io = true;
+      continue;
+    }
+    if (strcmp(argv[i], "--mmap") == 0) {
+      mmap_reads = true;
+      continue;
+    }
+    if (strcmp(argv[i], "--huge-pages") == 0) {
+      bustub::enable_huge_pages = true;
+      continue;
+    }
     if (strcmp(argv[i], "--emoji-prompt") == 0) {
       use_emoji_prompt = true;
-      break;
+      continue;
     }
     if (strcmp(argv[i], "--disable-tty") == 0) {
       disable_tty = true;
-      break;
+      continue;
     }
   }
 
+  auto bustub = std::make_unique<bustub::BustubInstance>("test.db", replacer_policy, pool_size, max_pool_size,
+                                                         direct_io, mmap_reads);
+
   bustub->GenerateMockTable();
 
   if (bustub->buffer_pool_manager_ != nullptr) {
@@ -147,6 +147,10 @@ auto main(int argc, char **argv) -> int {  // NOLINT
   program.add_argument("--verbose").help("increase output verbosity").default_value(false).implicit_value(true);
   program.add_argument("-d", "--diff").help("write diff file").default_value(false).implicit_value(true);
   program.add_argument("--in-memory").help("use in-memory backend").default_value(false).implicit_value(true);
+  program.add_argument("--buffer-pool-size")
+      .help("number of buffer pool frames")
+      .default_value(static_cast<size_t>(bustub::BUSTUB_INSTANCE_POOL_SIZE))
+      .scan<'u', size_t>();
 
   try {
     program.parse_args(argc, argv);
@@ -173,10 +177,11 @@ auto main(int argc, char **argv) -> int {  // NOLINT
 
   std::unique_ptr<bustub::BustubInstance> bustub;
 
+  auto pool_size = program.get<size_t>("--buffer-pool-size");
   if (program.get<bool>("--in-memory")) {
-    bustub = std::make_unique<bustub::BustubInstance>();
+    bustub = std::make_unique<bustub::BustubInstance>(pool_size);
   } else {
-    bustub = std::make_unique<bustub::BustubInstance>("test.db");
+    bustub = std::make_unique<bustub::BustubInstance>("test.db", bustub::ReplacerPolicy::LRU_K, pool_size);
   }
 
   bustub->GenerateMockTable();
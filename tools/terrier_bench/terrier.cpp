@@ -120,6 +120,7 @@ auto main(int argc, char **argv) -> int {
   program.add_argument("--duration").help("run terrier bench for n milliseconds");
   program.add_argument("--force-create-index").help("create index in terrier bench");
   program.add_argument("--force-enable-update").help("use update statement in terrier bench");
+  program.add_argument("--buffer-pool-size").help("number of buffer pool frames");
 
   try {
     program.parse_args(argc, argv);
@@ -129,7 +130,11 @@ auto main(int argc, char **argv) -> int {
     return 1;
   }
 
-  auto bustub = std::make_unique<bustub::BustubInstance>();
+  size_t pool_size = bustub::BUSTUB_INSTANCE_POOL_SIZE;
+  if (program.present("--buffer-pool-size")) {
+    pool_size = std::stoul(program.get("--buffer-pool-size"));
+  }
+  auto bustub = std::make_unique<bustub::BustubInstance>(pool_size);
   auto writer = bustub::SimpleStreamWriter(std::cerr);
 
   // create schema